@@ -18,14 +18,83 @@
 
 #include "core/terminal.hpp"
 #include "actions/cheats.hpp"
+#include "actions/world-interaction.hpp"
+#include "util/alloc-count.hpp"
+#include "util/format.hpp"
+#include "util/strx.hpp"
+#include "world/area/region.hpp"
+#include "world/area/room.hpp"
+#include "world/entity/player.hpp"
 #include "world/time/time-weather.hpp"
 #include "world/world.hpp"
 
-using std::to_string;
+using std::string;
+using std::vector;
 using westgate::terminal::print;
 
 namespace westgate::actions::cheats {
 
+#ifdef WESTGATE_BUILD_DEBUG
+// Counts how many times memory is allocated while looking around and travelling, which should be next to none once everything has been used once.
+void allocs(PARSER_FUNCTION)
+{ PARSER_NO_WORDS PARSER_NO_HASHED
+    // A pair of rooms leading into each other is added to the player's Region for the test, so there's always a real journey to measure, whatever the game
+    // data has to offer. The player is moved there and back again afterwards, and the rooms are removed.
+    Room* start_room = player().parent_room();
+    Region* region = world().load_region(start_room->region());
+    auto make_room = [](const string &id, const string &name, Direction exit_dir, const string &exit_to) {
+        auto room = std::make_unique<Room>(id);
+        room->set_name(name, name, false);
+        room->set_desc("An empty room, set up for counting memory allocations.", false);
+        room->set_map_char("{w}#", false);
+        room->set_tag(RoomTag::Indoors, false);
+        room->set_link(exit_dir, strx::murmur3(exit_to), false);
+        return room;
+    };
+    Room* room_a = region->debug_add_room(make_room("ALLOCS_FIXTURE_A", "Fixture Room A", Direction::NORTH, "ALLOCS_FIXTURE_B"));
+    region->debug_add_room(make_room("ALLOCS_FIXTURE_B", "Fixture Room B", Direction::SOUTH, "ALLOCS_FIXTURE_A"));
+    start_room->transfer(&player(), room_a);
+
+    // The commands are set up in advance, just as the parser would, so that only the work done by the commands themselves is counted. Each cycle looks
+    // around, travels north and back south again, and tries to travel east, where there is no exit.
+    vector<hash_wg> look_hashed = { strx::murmur3("look") }, north_hashed = { strx::murmur3("north") }, south_hashed = { strx::murmur3("south") },
+        east_hashed = { strx::murmur3("east") };
+    vector<string> look_words = { "look" }, north_words = { "north" }, south_words = { "south" }, east_words = { "east" };
+    auto cycle = [&] {
+        world_interaction::look(look_hashed, look_words);
+        world_interaction::travel(north_hashed, north_words);
+        world_interaction::travel(south_hashed, south_words);
+        world_interaction::travel(east_hashed, east_words);
+        terminal::flush();
+    };
+
+    // The first cycle fills the caches and grows the buffers, so it's counted separately.
+    constexpr int CYCLES = 5;
+    unsigned long long warm_up_start = 0, start = 0, end = 0;
+    try
+    {
+        warm_up_start = alloc_count::allocations();
+        cycle();
+        start = alloc_count::allocations();
+        for (int i = 0; i < CYCLES; i++)
+            cycle();
+        end = alloc_count::allocations();
+    }
+    catch (...)
+    {
+        player().parent_room()->transfer(&player(), start_room);
+        region->debug_remove_room(strx::murmur3("ALLOCS_FIXTURE_A"));
+        region->debug_remove_room(strx::murmur3("ALLOCS_FIXTURE_B"));
+        throw;
+    }
+    player().parent_room()->transfer(&player(), start_room);
+    region->debug_remove_room(strx::murmur3("ALLOCS_FIXTURE_A"));
+    region->debug_remove_room(strx::murmur3("ALLOCS_FIXTURE_B"));
+    print(Format{"Memory was allocated {C}%d {w}times over {C}%d {w}cycles of looking, travelling there and back, and failing to travel, after {C}%d "
+        "{w}times in the first cycle.", end - start, CYCLES, start - warm_up_start});
+}
+#endif  // WESTGATE_BUILD_DEBUG
+
 // Hashes words into integers.
 void hash(PARSER_FUNCTION)
 {
@@ -34,7 +103,21 @@ void hash(PARSER_FUNCTION)
         print("{Y}Please specify a word to be hashed.");
         return;
     }
-    print("The hashed version of {C}" + words.at(1) + " {w}is {C}" + to_string(words_hashed.at(1)));
+    print(Format{"The hashed version of {C}%s {w}is {C}%d", words.at(1), words_hashed.at(1)});
+}
+
+// Shows how often looking around has been able to reuse the cached room output.
+void look_stats(PARSER_FUNCTION)
+{ PARSER_NO_WORDS PARSER_NO_HASHED
+    const Room::RenderStats &stats = Room::render_stats();
+    print(Format{"Room output cache: {C}%d {w}hits, {C}%d {w}misses.", stats.hits, stats.misses});
+}
+
+// Reloads the game data for the currently-loaded Regions.
+void reload(PARSER_FUNCTION)
+{ PARSER_NO_WORDS PARSER_NO_HASHED
+    world().reload_regions();
+    player().parent_room()->look();
 }
 
 }   // namespace westgate::actions::cheats
@@ -23,6 +23,11 @@
 
 namespace westgate::actions::cheats {
 
+#ifdef WESTGATE_BUILD_DEBUG
+void    allocs(PARSER_FUNCTION);    // Counts how many times memory is allocated while looking around and travelling. Debug builds only.
+#endif
 void    hash(PARSER_FUNCTION);  // Hashes words into integers.
+void    look_stats(PARSER_FUNCTION);    // Shows how often looking around has been able to reuse the cached room output.
+void    reload(PARSER_FUNCTION);    // Reloads the game data for the currently-loaded Regions.
 
 }   // namespace westgate::actions::cheats
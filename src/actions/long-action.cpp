@@ -0,0 +1,69 @@
+// actions/long-action.cpp -- Actions which take a long time in the game world, such as waiting or resting. Rather than passing all the time in one go, these
+// are advanced a slice at a time by the main loop, so they can be interrupted by events in the game, or by the player typing something.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "actions/long-action.hpp"
+#include "core/terminal.hpp"
+#include "world/time/time-weather.hpp"
+#include "world/world.hpp"
+
+using westgate::terminal::print;
+
+namespace westgate::actions {
+
+// Creates a new long action, which will take the specified amount of game time.
+LongAction::LongAction(Type type, unsigned long long seconds) : remaining_(seconds), type_(type) { }
+
+// Runs the next slice of this action. Returns false once the action has finished, or been interrupted.
+bool LongAction::advance()
+{
+    if (!remaining_) return false;
+    TimeWeather &time_weather = world().time_weather();
+    const unsigned long long slice = std::min<unsigned long long>(remaining_, SLICE);
+    const unsigned long long time_before = time_weather.time_passed();
+    const bool completed = time_weather.pass_time(slice, true);
+
+    // If time was interrupted partway through the slice, only the time that actually passed is counted.
+    const unsigned long long time_taken = time_weather.time_passed() - time_before;
+    remaining_ -= std::min(remaining_, time_taken);
+    if (!completed)
+    {
+        interrupt();
+        return false;
+    }
+    return remaining_ > 0;
+}
+
+// Stops this action before it's finished.
+void LongAction::interrupt()
+{
+    if (!remaining_) return;
+    remaining_ = 0;
+    switch (type_)
+    {
+        case Type::WAIT: print("{y}You stop waiting."); break;
+    }
+}
+
+// Returns how much game time is left before this action finishes.
+unsigned long long LongAction::remaining() const { return remaining_; }
+
+// Returns the type of this action.
+LongAction::Type LongAction::type() const { return type_; }
+
+}   // namespace westgate::actions
@@ -0,0 +1,42 @@
+// actions/long-action.hpp -- Actions which take a long time in the game world, such as waiting or resting. Rather than passing all the time in one go, these
+// are advanced a slice at a time by the main loop, so they can be interrupted by events in the game, or by the player typing something.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+namespace westgate::actions {
+
+class LongAction {
+public:
+    enum class Type : unsigned char { WAIT };
+
+                LongAction(Type type, unsigned long long seconds);  // Creates a new long action, which will take the specified amount of game time.
+    bool        advance();      // Runs the next slice of this action. Returns false once the action has finished, or been interrupted.
+    void        interrupt();    // Stops this action before it's finished.
+    unsigned long long  remaining() const;  // Returns how much game time is left before this action finishes.
+    Type        type() const;   // Returns the type of this action.
+
+private:
+    static constexpr int    SLICE = 3600;   // The most game time that can pass in a single slice, in seconds.
+
+    unsigned long long  remaining_; // The game time left before this action finishes.
+    Type                type_;      // The type of this action.
+};
+
+}   // namespace westgate::actions
@@ -16,10 +16,13 @@
  * GNU Affero General Public License for more details.
  */
 
+#include "actions/long-action.hpp"
 #include "actions/world-interaction.hpp"
 #include "core/core.hpp"
+#include "core/game.hpp"
 #include "core/terminal.hpp"
 #include "parser/parser.hpp"
+#include "util/format.hpp"
 #include "util/strx.hpp"
 #include "world/area/room.hpp"
 #include "world/entity/player.hpp"
@@ -27,7 +30,6 @@
 #include "world/time/timing.hpp"
 #include "world/world.hpp"
 
-using std::string;
 using westgate::terminal::print;
 
 namespace westgate::actions::world_interaction {
@@ -42,18 +44,18 @@ void look(PARSER_FUNCTION)
 void open_close(PARSER_FUNCTION)
 { PARSER_NO_WORDS
     const bool open = (words_hashed.at(0) == 21229531);
-    const string open_close = (open ? "open" : "close");
-    const string open_closed = (open ? "open" : "closed");
+    const char* open_close = (open ? "open" : "close");
+    const char* open_closed = (open ? "open" : "closed");
 
     if (words_hashed.size() < 2)
     {
-        print("{Y}Please specify a direction to " + open_close + " something.");
+        print(Format{"{Y}Please specify a direction to %s something.", open_close});
         return;
     }
     Direction dir = parser::parse_direction(words_hashed.at(1));
     if (dir == Direction::NONE)
     {
-        print("{Y}I don't understand. Please specify a direction to " + open_close + " something.");
+        print(Format{"{Y}I don't understand. Please specify a direction to %s something.", open_close});
         return;
     }
 
@@ -65,29 +67,29 @@ void open_close(PARSER_FUNCTION)
             if (open) print("{Y}You try to open it, but it's locked.");
             else print("{Y}It's already closed.");
         }
-        else print("{Y}There isn't anything to " + open_close + " in that direction.");
+        else print(Format{"{Y}There isn't anything to %s in that direction.", open_close});
         return;
     }
     if (!room->link_tag(dir, LinkTag::Openable))
     {
-        print("{Y}That isn't something you can " + open_close + "!");
+        print(Format{"{Y}That isn't something you can %s!", open_close});
         return;
     }
     if (const bool is_open = room->link_tag(dir, LinkTag::Open);
         (open && is_open) || (!open && !is_open))
     {
-        print("{Y}It's already " + open_closed + ".");
+        print(Format{"{Y}It's already %s.", open_closed});
         return;
     }
     if (room->link_tag(dir, LinkTag::Locked) || room->link_tag(dir, LinkTag::Permalock))
     {
-        print("{Y}You try to open the " + room->door_name(dir) + ", but it's locked.");
+        print(Format{"{Y}You try to open the %s, but it's locked.", room->door_name(dir)});
         room->set_link_tag(dir, LinkTag::AwareOfLock);
         return;
     }
 
     world().open_close_lock_unlock_no_checks(room, dir, (open ? World::OpenCloseLockUnlock::OPEN : World::OpenCloseLockUnlock::CLOSE), &player());
-    print("You " + open_close + " the " + room->door_name(dir) + ".");
+    print(Format{"You %s the %s.", open_close, room->door_name(dir)});
 }
 
 // Travels in a specific direction.
@@ -122,7 +124,7 @@ void travel(PARSER_FUNCTION)
 
     if ((room_here->link_tag(dir, LinkTag::Locked) || room_here->link_tag(dir, LinkTag::Permalock)) && !room_here->link_tag(dir, LinkTag::Open))
     {
-        print("{Y}You can't go that way, the " + room_here->door_name(dir) + " is locked.");
+        print(Format{"{Y}You can't go that way, the %s is locked.", room_here->door_name(dir)});
         room_here->set_link_tag(dir, LinkTag::AwareOfLock);
         return;
     }
@@ -131,12 +133,12 @@ void travel(PARSER_FUNCTION)
     {
         if (!room_here->link_tag(dir, LinkTag::Open))
         {
-            print("{B}(first opening the " + room_here->door_name(dir) + ")");
+            print(Format{"{B}(first opening the %s)", room_here->door_name(dir)});
             world().open_close_lock_unlock_no_checks(room_here, dir, World::OpenCloseLockUnlock::OPEN, &player());
         }
     }
 
-    print(string("You travel ") + (dir == Direction::UP || dir == Direction::DOWN ? "" : "to the ") + Room::direction_name(dir) + ".");
+    print(Format{"You travel %s%s.", (dir == Direction::UP || dir == Direction::DOWN ? "" : "to the "), Room::direction_name(dir)});
     room_here->transfer(&player(), room_target);
     world().time_weather().pass_time(timing::TIME_TO_MOVE);
     look(words_hashed, words);
@@ -148,7 +150,7 @@ void wait(PARSER_FUNCTION)
     if (words_hashed.size() < 2)
     {
         print("Time passes...");
-        world().time_weather().pass_time(timing::TIME_TO_WAIT, true);
+        game().start_long_action(std::make_unique<LongAction>(LongAction::Type::WAIT, timing::TIME_TO_WAIT));
         return;
     }
     if (words_hashed.size() < 3)
@@ -168,7 +170,7 @@ void wait(PARSER_FUNCTION)
         print("{Y}Don't be ridiculous.");
         return;
     }
-    string time_str;
+    const char* time_str;
     switch(words_hashed.at(2))
     {
         case 1296922301: case 3652255926: time_str = "second"; break;
@@ -179,9 +181,8 @@ void wait(PARSER_FUNCTION)
             print("{Y}I don't understand. Please specify how long you want to wait in {G}seconds{Y}, {G}minutes{Y}, {G}hours{Y} or {G}days{Y}.");
             return;
     }
-    print("You prepare to wait for " + strx::number_to_text(original_amount) + " " + time_str + (original_amount > 1 ? "s" : "") +
-        ". Time passes...");
-    world().time_weather().pass_time(amount, true);
+    print(Format{"You prepare to wait for %s %s%s. Time passes...", strx::number_to_text(original_amount), time_str, (original_amount > 1 ? "s" : "")});
+    game().start_long_action(std::make_unique<LongAction>(LongAction::Type::WAIT, amount));
 }
 
 }   // westgate::actions::world_interaction namespace
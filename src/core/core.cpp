@@ -31,7 +31,9 @@
 #include "core/game.hpp"
 #include "core/terminal.hpp"
 #include "util/filex.hpp"
+#include "util/format.hpp"
 #include "util/strx.hpp"
+#include "util/thread-pool.hpp"
 #include "util/timer.hpp"
 #include "util/yaml.hpp"
 
@@ -49,8 +51,18 @@ namespace westgate {
 void core_intercept_signal(int sig) { core().intercept_signal(sig); }
 
 // Constructor, sets up the Core object.
-Core::Core() : cascade_count_(0), cascade_failure_(false), cascade_timer_(std::time(0)), dead_already_(0), lock_stderr_(false), stderr_old_(nullptr),
-    game_ptr_(nullptr) { }
+Core::Core() : cascade_count_(0), cascade_failure_(false), cascade_timer_(std::time(0)), dead_already_(0), lock_stderr_(false), real_time_(false),
+    stderr_old_(nullptr), title_choice_(0), watch_mode_(false), game_ptr_(nullptr), thread_pool_ptr_(nullptr) { }
+
+// Checks that the gamedata folder is the version we expect.
+void Core::check_gamedata_version()
+{
+    YAML yaml_file(datafile("westgate.yml"));
+    if (!yaml_file.is_map() || !yaml_file.key_exists("westgate_gamedata_version")) throw runtime_error("westgate.yml: Invalid file format!");
+    const unsigned int data_version = std::stoul(yaml_file.val("westgate_gamedata_version"));
+    if (data_version != WESTGATE_GAMEDATA_VERSION) throw runtime_error("Unexpected gamedata version! (" + to_string(data_version) + ", expected " +
+        to_string(WESTGATE_GAMEDATA_VERSION) + ")");
+}
 
 // Checks stderr for any updates, puts them in the log if any exist.
 void Core::check_stderr()
@@ -70,11 +82,16 @@ void Core::check_stderr()
 // Cleans up all Core-managed objects.
 void Core::cleanup()
 {
-    std::cout << rang::style::reset << '\n';    // Reset any lingering ANSI codes.
-    std::cout.flush();  // Ensure anything left on the console output buffer (including the reset code we just added) is flushed.
+    terminal::flush();  // Write out anything still waiting in the terminal's output buffer.
+    if (terminal::output_mode() == terminal::Output::CONSOLE)
+    {
+        std::cout << rang::style::reset << '\n';    // Reset any lingering ANSI codes.
+        std::cout.flush();  // Ensure anything left on the console output buffer (including the reset code we just added) is flushed.
+    }
 
-    // Release all attached objects.
+    // Release all attached objects. The Game goes first, as it waits for any background tasks it started.
     game_ptr_.reset(nullptr);
+    thread_pool_ptr_.reset(nullptr);
 
     close_log();    // Close the log file.
 }
@@ -147,12 +164,6 @@ void Core::find_gamedata()
         gamedata_location_ = source_path_data;
     }
     else throw runtime_error("Could not locate valid gamedata folder!");
-
-    YAML yaml_file(datafile("westgate.yml"));
-    if (!yaml_file.is_map() || !yaml_file.key_exists("westgate_gamedata_version")) throw runtime_error("westgate.yml: Invalid file format!");
-    const unsigned int data_version = std::stoul(yaml_file.val("westgate_gamedata_version"));
-    if (data_version != WESTGATE_GAMEDATA_VERSION) this->halt("Unexpected gamedata version! (" + to_string(data_version) + ", expected " +
-        to_string(WESTGATE_GAMEDATA_VERSION) + ")");
 }
 
 // Returns a reference to the Game manager object.
@@ -211,6 +222,9 @@ void Core::hook_signals()   // Hook system failure signals.
 #ifdef INVICTUS_TARGET_LINUX
     if (signal(SIGBUS, core_intercept_signal) == SIG_ERR) halt("Failed to hook bus error signal.");
 #endif
+#ifndef WESTGATE_TARGET_WINDOWS
+    if (signal(SIGWINCH, terminal::window_resized) == SIG_ERR) halt("Failed to hook window resize signal.");
+#endif
 }
 
 // Sets up the core game classes and data, and the terminal subsystem.
@@ -227,6 +241,7 @@ void Core::init_core(vector<string> parameters)
         {
             core().log("Disabling ANSI colour codes.");
             rang::setControlMode(rang::control::Off);
+            set_title = false;
         }
         else if (param == "-force-colour" || param == "-force-color")
         {
@@ -234,6 +249,26 @@ void Core::init_core(vector<string> parameters)
             rang::setControlMode(rang::control::Force);
             set_title = true;
         }
+        else if (param == "-watch")
+        {
+            core().log("Watching game data for changes.");
+            watch_mode_ = true;
+        }
+        else if (param == "-real-time")
+        {
+            core().log("Running the game world in real time.");
+            real_time_ = true;
+        }
+        else if (param == "-headless" || param == "-headless-json")
+        {
+            const bool json = (param == "-headless-json");
+            core().log(json ? "Writing output as JSON events." : "Writing output as plain text.");
+            terminal::set_output_mode(json ? terminal::Output::JSON : terminal::Output::PLAIN);
+            rang::setControlMode(rang::control::Off);
+            set_title = false;
+        }
+        else if (param == "-new-game") title_choice_ = 1;
+        else if (param == "-load-game") title_choice_ = 2;
 
 #ifdef WESTGATE_TARGET_WINDOWS
         else if (param == "-native")
@@ -251,6 +286,8 @@ void Core::init_core(vector<string> parameters)
 
     if (set_title) terminal::set_window_title("Westgate v" + version::VERSION_STRING + " (" + version::BUILD_TIMESTAMP + ")");
     find_gamedata();
+    thread_pool_ptr_ = std::make_unique<ThreadPool>();
+    this->log("Started " + to_string(thread_pool_ptr_->threads()) + " worker threads.");
     game_ptr_ = std::make_unique<Game>();
 #ifdef WESTGATE_BUILD_DEBUG
     this->log("Core initialized in " + strx::ftos(init_timer.elapsed() / 1000.0f, 3) + " seconds.");
@@ -289,10 +326,13 @@ void Core::intercept_signal(int sig)
 // Logs a message in the system log file.
 void Core::log(const string_view msg, int type)
 {
+    std::lock_guard<std::recursive_mutex> lock(log_mutex_);
     if (!syslog_.is_open()) return;
     if (!lock_stderr_) check_stderr();
 
-    string txt_tag;
+    if (type != CORE_INFO) terminal::flush();   // Anything already printed should appear before the warning, not after it.
+    const bool json = (terminal::output_mode() == terminal::Output::JSON);  // ANSI colours are always turned off in the headless modes.
+    const char* txt_tag = "";
     switch(type)
     {
         case CORE_INFO: break;
@@ -301,7 +341,7 @@ void Core::log(const string_view msg, int type)
         case CORE_CRITICAL: txt_tag = "[CRITICAL] "; std::cout << rang::bg::red << rang::fg::black; break;
     }
 
-    char* buffer = new char[32];
+    char time_str[16];
     const time_t now = std::time(nullptr);
 #if defined(WESTGATE_TARGET_WINDOWS) && !defined(WESTGATE_TARGET_MINGW)
     tm time_struct;
@@ -310,18 +350,27 @@ void Core::log(const string_view msg, int type)
 #else
     const tm *ptm = std::localtime(&now);
 #endif
-    std::strftime(&buffer[0], 32, "%H:%M:%S", ptm);
-    string time_str = &buffer[0], msg_str = string{msg};
-    msg_str = "[" + time_str + "] " + txt_tag + msg_str;
-    syslog_ << msg_str << std::endl;
-    delete[] buffer;
+    if (!std::strftime(time_str, sizeof(time_str), "%H:%M:%S", ptm)) time_str[0] = 0;
+    const Format line{"[%s] %s%s", time_str, txt_tag, msg};
+    syslog_ << line.view() << std::endl;
 
-    if (type != CORE_INFO) std::cout << msg_str << rang::style::reset << std::endl;
+    if (type != CORE_INFO && json)
+    {
+        static constexpr const char* levels[] = { "info", "warn", "error", "critical" };
+        terminal::print_json(Format{"{\"type\":\"log\",\"level\":\"%s\",\"text\":%s}", levels[type], strx::json_quote(msg)});
+        terminal::flush();
+    }
+    else if (type != CORE_INFO)
+    {
+        std::cout << line.view() << rang::style::reset << std::endl;
+        terminal::cursor_moved();
+    }
 }
 
 // Reports a non-fatal error, which will be logged but will not halt execution unless it cascades.
 void Core::nonfatal(const string_view error, int type)
 {
+    std::lock_guard<std::recursive_mutex> lock(log_mutex_);
     if (cascade_failure_ || dead_already_) return;
     int cascade_weight = 0;
     switch(type)
@@ -369,12 +418,29 @@ void Core::open_log()
     this->log("Logging and error-handling system is online.");
 }
 
+// Checks if time should pass in the game world while the game waits for the player's input.
+bool Core::real_time() const { return real_time_; }
+
+// Returns the title screen option chosen on the command line, or 0 if the player should be asked.
+int Core::title_choice() const { return title_choice_; }
+
+// Returns a reference to the worker thread pool.
+ThreadPool& Core::thread_pool() const
+{
+    if (!thread_pool_ptr_) throw runtime_error("Attempt to access null ThreadPool pointer!");
+    return *thread_pool_ptr_;
+}
+
+// Checks if the game data should be watched for changes, and reloaded while the game runs.
+bool Core::watch_mode() const { return watch_mode_; }
+
 // A shortcut to using Core::core().
 Core& core() { return Core::core(); }
 
 }   // namespace westgate
 
-// Main program entry point. Must be OUTSIDE the westgate namespace.
+#ifndef WESTGATE_NO_MAIN
+// Main program entry point. Must be OUTSIDE the westgate namespace. Tools which are built from the game's source (e.g. the weather simulation) have their own.
 int main(int argc, char** argv)
 {
     // Create the main Core object.
@@ -395,3 +461,4 @@ int main(int argc, char** argv)
     westgate::core().destroy_core(EXIT_SUCCESS);
     return EXIT_SUCCESS;    // Technically not needed, as destroy_core() calls exit(), but this'll keep the compiler happy.
 }
+#endif  // WESTGATE_NO_MAIN
@@ -21,11 +21,13 @@
 
 #include <ctime>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 namespace westgate {
 
-class Game; // defined in core/game.hpp
+class Game;         // defined in core/game.hpp
+class ThreadPool;   // defined in util/thread-pool.hpp
 
 class Core {
 public:
@@ -34,6 +36,7 @@ public:
     static constexpr int    CORE_ERROR =    2;  // Serious errors. Shit is going down.
     static constexpr int    CORE_CRITICAL = 3;  // Critical system failure.
 
+    void                check_gamedata_version();       // Checks that the gamedata folder is the version we expect.
     void                check_stderr();                 // Checks stderr for any updates, puts them in the log if any exist.
     static Core&        core();                         // Returns a reference to the singleton Core object.
     const std::string   datafile(const std::string_view file);  // Returns the full path to a specified game data file.
@@ -47,6 +50,10 @@ public:
     void                log(const std::string_view msg, int type = CORE_INFO);  // Logs a message in the system log file.
                         // Reports a non-fatal error, which will be logged but won't halt execution unless it cascades.
     void                nonfatal(const std::string_view error, int type);
+    bool                real_time() const;              // Checks if time should pass in the game world while the game waits for the player's input.
+    ThreadPool&         thread_pool() const;            // Returns a reference to the worker thread pool.
+    int                 title_choice() const;           // Returns the title screen option chosen on the command line, or 0 if the player should be asked.
+    bool                watch_mode() const;             // Checks if the game data should be watched for changes, and reloaded while the game runs.
 
 private:
     static constexpr int            ERROR_CASCADE_THRESHOLD =       25; // The amount cascade_count can reach within CASCADE_TIMEOUT seconds before it aborts.
@@ -62,11 +69,16 @@ private:
     int                 dead_already_;      // Have we already died? Is this crash within the Core subsystem?
     std::string         gamedata_location_; // The path of the game's data files.
     bool                lock_stderr_;       // Whether the stderr-checking code is allowed to run or not.
+    std::recursive_mutex    log_mutex_;     // Allows log() and nonfatal() to be called from worker threads.
+    bool                real_time_;         // Should time pass in the game world while the game waits for the player's input?
     std::stringstream   stderr_buffer_;     // Pointer to a stringstream buffer used to catch stderr messages.
     std::streambuf*     stderr_old_;        // The old stderr buffer.
     std::ofstream       syslog_;            // The system log file.
+    int                 title_choice_;      // The title screen option chosen on the command line, or 0 if the player should be asked.
+    bool                watch_mode_;        // Should the game data be watched for changes, and reloaded while the game runs?
 
     std::unique_ptr<Game>   game_ptr_;      // Pointer to the Game manager object, which handles the current game state.
+    std::unique_ptr<ThreadPool> thread_pool_ptr_;   // Pointer to the worker thread pool, used for loading data in the background.
 
             Core();         // Constructor, sets up the Core object.
     void    cleanup();      // Attempts to gracefully clean up memory and subsystems.
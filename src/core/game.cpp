@@ -18,17 +18,22 @@
 
 #include <filesystem>
 
+#include "actions/long-action.hpp"
 #include "cmake/version.hpp"
 #include "core/core.hpp"
 #include "core/game.hpp"
 #include "core/terminal.hpp"
 #include "parser/parser.hpp"
 #include "util/filex.hpp"
+#include "util/format.hpp"
+#include "util/namegen.hpp"
+#include "util/random.hpp"
 #include "util/strx.hpp"
 #include "util/timer.hpp"
 #include "world/area/region.hpp"
 #include "world/entity/player.hpp"
 #include "world/time/time-weather.hpp"
+#include "world/time/timing.hpp"
 #include "world/world.hpp"
 
 using std::runtime_error;
@@ -41,7 +46,7 @@ namespace fs = std::filesystem;
 namespace westgate {
 
 // Constructor, sets up the game manager.
-Game::Game() : player_ptr_(nullptr), save_id_(-1), world_ptr_(nullptr) { }
+Game::Game() : long_action_(nullptr), player_ptr_(nullptr), save_id_(-1), world_ptr_(nullptr) { }
 
 // Destructor, cleans up attached classes.
 Game::~Game() { world_ptr_.reset(nullptr); }
@@ -51,8 +56,15 @@ void Game::begin()
 {
     world_ptr_ = std::make_unique<World>();
     title_screen();
+    if (core().watch_mode()) world_ptr_->watch_gamedata();
     print();
     player_ptr_->parent_room()->look();
+
+    // If the console window changes width, the room description is drawn again to fit.
+    terminal::set_resize_handler([this] {
+        print();
+        player_ptr_->parent_room()->look();
+    });
     main_loop();
 }
 
@@ -93,6 +105,10 @@ void Game::load_game(int save_slot)
     // Check what Region the player is in.
     const int current_region = file->read_data<int>();
 
+    // Load the world seed, and the name generator's random number stream.
+    world_ptr_->set_seed(file->read_data<uint64_t>());
+    world_ptr_->namegen().rng().load_data(file.get());
+
     // Load the time/weather data.
     world_ptr_->time_weather().load_data(file.get());
 
@@ -108,13 +124,36 @@ void Game::load_game(int save_slot)
 }
 
 // brøether, may i have the lööps
-void Game::main_loop() { while(true) { parser::process_input(terminal::get_input()); } }
+void Game::main_loop()
+{
+    while(true)
+    {
+        // Long actions are run a slice at a time. If the player types anything, the action stops, and whatever they typed is processed as normal. Scripts
+        // send their commands without waiting to see what happens, so they don't interrupt anything.
+        if (long_action_)
+        {
+            if (terminal::output_mode() == terminal::Output::CONSOLE && terminal::input_pending()) long_action_->interrupt();
+            if (!long_action_->advance()) long_action_.reset(nullptr);
+            terminal::flush();
+            continue;
+        }
+
+        if (core().real_time()) real_time_wait();
+        const string input = terminal::get_input();
+        world_ptr_->check_for_changes();
+        parser::process_input(input);
+    }
+}
 
 // Sets up for a new game!
 void Game::new_game(int starting_region, string_view starting_room)
 {
     Timer new_game_timer;
 
+    // Everything random in the game world is derived from a single seed, so the same seed always plays out the same way.
+    world_ptr_->set_seed(rnd::get<uint64_t>(0, UINT64_MAX));
+    world_ptr_->time_weather().reset(world_ptr_->seed());
+
     // Create the new region delta save files.
     world_ptr_->create_region_saves(save_id_);
 
@@ -134,6 +173,24 @@ void Game::new_game(int starting_region, string_view starting_room)
 // Returns a reference to the Player object.
 Player& Game::player() const { return *player_ptr_; }
 
+// In real-time mode, lets time pass in the game world until the player has finished typing a command.
+void Game::real_time_wait()
+{
+    // Rather than busy-waiting, this sleeps until either a whole line of input is ready, or the world is due to catch up with the real world again. Whatever
+    // gets printed while the player is typing clears the prompt away, so it's put back each time around.
+    Timer tick_timer;
+    bool input_ready = false;
+    while (!input_ready)
+    {
+        terminal::check_resize();
+        terminal::show_prompt();
+        input_ready = terminal::input_pending(REAL_TIME_TICK);
+        const unsigned int elapsed = tick_timer.elapsed();
+        tick_timer.reset();
+        world_ptr_->time_weather().pass_time(elapsed * timing::REAL_TIME_SCALE / 1000.0f);
+    }
+}
+
 // Save the game, if there's a game in progress.
 void Game::save(bool chatty)
 {
@@ -155,8 +212,10 @@ void Game::save_misc_data()
     file->write_data<unsigned int>(MISC_DATA_SAVE_VERSION);
     file->write_string("MISC_DATA");
 
-    // The only misc data to write for now is the player's region ID.
+    // The player's region ID, then the world seed and the name generator's random number stream.
     file->write_data<int>(player_ptr_->region());
+    file->write_data<uint64_t>(world_ptr_->seed());
+    world_ptr_->namegen().rng().save_data(file.get());
 
     // And the time/weather data, which is saved elsewhere.
     world_ptr_->time_weather().save_data(file.get());
@@ -175,21 +234,34 @@ void Game::set_player(Player* player_ptr)
     player_ptr_ = player_ptr;
 }
 
+// Starts an action which takes a long time, replacing any already underway.
+void Game::start_long_action(std::unique_ptr<actions::LongAction> action)
+{
+    if (long_action_) long_action_->interrupt();
+    long_action_ = std::move(action);
+}
+
 // Every game needs a title screen!
 void Game::title_screen()
 {
-    print("\n{c}Welcome to {C}Westgate {c}version " + version::VERSION_STRING + " (build " + version::BUILD_TIMESTAMP + ")");
+    print(Format{"\n{c}Welcome to {C}Westgate {c}version %s (build %s)", version::VERSION_STRING, version::BUILD_TIMESTAMP});
     print("{c}Copyright (c) 2015 Raine \"Gravecat\" Simmons\n");
 
-    print("Please select one of the following options:");
-    print("{K}[{G}1{K}] {w}Start a new game");
-    print("{K}[{G}2{K}] {w}Load a saved game");
-    print("{K}[{G}3{K}] {w}Quit the game");
-
     // Right now, we're hard-coding save slot 0. Later, we'll let the user pick a save slot.
     save_id_ = 0;
 
-    switch(terminal::get_number(1, 3))
+    // The choice can be made on the command line instead, so scripts and bots don't have to answer the menu.
+    int choice = core().title_choice();
+    if (!choice)
+    {
+        print("Please select one of the following options:");
+        print("{K}[{G}1{K}] {w}Start a new game");
+        print("{K}[{G}2{K}] {w}Load a saved game");
+        print("{K}[{G}3{K}] {w}Quit the game");
+        choice = terminal::get_number(1, 3);
+    }
+    if (choice != 3) world_ptr_->finish_loading();
+    switch(choice)
     {
         case 1: new_game(0, "THE_CROWN_AND_SKULL"); break;
         case 2: load_game(0); break;
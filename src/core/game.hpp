@@ -23,6 +23,7 @@ namespace westgate {
 
 class Player;   // defined in world/entity/player.hpp
 class World;    // defined in world/world.hpp
+namespace actions { class LongAction; } // defined in actions/long-action.hpp
 
 class Game {
 public:
@@ -34,11 +35,14 @@ public:
     void    save(bool chatty = true);   // Save the game, if there's a game in progress.
     int     save_slot() const;  // Returns the currently-used saved game slot.
     void    set_player(Player* player_ptr); // Sets the Player pointer. Use with caution.
+    void    start_long_action(std::unique_ptr<actions::LongAction> action);  // Starts an action which takes a long time, replacing any already underway.
     World&  world() const;  // Returns a reference to the World object.
 
 private:
-    static constexpr unsigned int   MISC_DATA_SAVE_VERSION = 6; // The version of the misc data file in save files. Changing this will make save files incompatible.
+    static constexpr unsigned int   MISC_DATA_SAVE_VERSION = 7; // The version of the misc data file in save files. Changing this will make save files incompatible.
+    static constexpr unsigned int   REAL_TIME_TICK = 1000;      // In real-time mode, the longest time (in milliseconds) the world goes without being updated.
 
+    std::unique_ptr<actions::LongAction>    long_action_;   // The long action currently underway, if any.
     Player* player_ptr_;    // Pointer to the player-character object. Ownership of the object lies with the Room they're in.
     int     save_id_;       // The current saved-game ID (or -1 for none).
     std::unique_ptr<World>  world_ptr_;     // The World object, which handles the state of the game world as well as the static data.
@@ -46,6 +50,7 @@ private:
     void    load_game(int save_slot);   // Loads an existing saved game.
     void    main_loop();        // brøether, may i have the lööps
     void    new_game(int starting_region, std::string_view starting_room);    // Sets up for a new game!
+    void    real_time_wait();   // In real-time mode, lets time pass in the game world until the player has finished typing a command.
     void    save_misc_data();   // Writes a misc save file, which contains everything that isn't in the region saves.
     void    title_screen();     // Every game needs a title screen!
 };
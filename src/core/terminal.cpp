@@ -16,17 +16,21 @@
  * GNU Affero General Public License for more details.
  */
 
+#include <csignal>
 #include <functional>
 #include <iostream>
+#include <mutex>
 
 #if defined(WESTGATE_TARGET_LINUX) || defined(WESTGATE_TARGET_APPLE)
 #include <cstdio>
 #include <sys/ioctl.h>
+#include <sys/select.h>
 #include <termios.h>
 #include <unistd.h>
 #endif
 
 #ifdef WESTGATE_TARGET_WINDOWS
+#include <conio.h>
 #include <fstream>
 #include <windows.h>
 #endif
@@ -34,24 +38,390 @@
 #include "3rdparty/rang/rang.hpp"
 #include "core/core.hpp"
 #include "core/terminal.hpp"
+#include "util/format.hpp"
+#include "util/scan.hpp"
+#include "util/strx.hpp"
+#include "util/styled-text.hpp"
+#include "util/utf8.hpp"
 
 using std::cout;
 using std::string;
 using std::string_view;
-using std::to_string;
 using std::vector;
 
 namespace westgate {
 namespace terminal {
 
+namespace {
+
+// Colour changes are stored in the output buffer as one of these bytes, followed by the colour tag's letter (except for MARK_FG_RESET), and applied with rang
+// when the buffer is flushed. That way they still work on Windows consoles which don't understand ANSI codes, where rang has to call the console API instead.
+constexpr char  MARK_FG =       '\x01';    // Sets the foreground colour, or resets all colours if followed by '0'.
+constexpr char  MARK_BG =       '\x02';    // Sets the background colour, or resets it if followed by '0'.
+constexpr char  MARK_FG_RESET = '\x03';    // Resets the foreground colour.
+
+constexpr unsigned int  FALLBACK_WIDTH = 80;   // The width used when the console's width can't be found, such as when output is going to a file or pipe.
+
+unsigned int            console_width = 0;  // The width of the console window, as it was the last time it was checked.
+std::string             json_line;  // Text printed without a newline in JSON mode, which is held back until the rest of the line arrives.
+std::string             output_buffer;  // Text waiting to be written to the console, with colour changes marked by the MARK_* bytes.
+unsigned int            output_column = 0;  // The column the cursor will be in, once the output buffer has been flushed.
+bool                    output_column_known = false;    // Is output_column accurate? If not, the terminal is asked where the cursor is before printing.
+Output                  output_mode_ = Output::CONSOLE; // How output is being written.
+std::recursive_mutex    output_mutex;   // Allows the output buffer to be flushed from other threads, such as when Core logs a warning.
+bool                    prompt_shown = false;   // Is the input prompt currently on the screen, waiting for the player to type?
+std::function<void()>   resize_handler; // Called when the console window changes width, to redraw whatever needs it.
+volatile std::sig_atomic_t  resize_pending = 1; // Set when the console window may have been resized, so its width needs checking again.
+std::string             typeahead;  // Anything the player typed while the game was reading from the terminal for other reasons.
+
+// Adds the marker bytes which change the colours from one style to another.
+void add_style_change(string &buffer, const StyledText::Style &from, const StyledText::Style &to)
+{
+    if (to == StyledText::Style{})
+    {
+        buffer += MARK_FG;
+        buffer += '0';
+        return;
+    }
+    if (to.fg != from.fg)
+    {
+        if (to.fg)
+        {
+            buffer += MARK_FG;
+            buffer += to.fg;
+        }
+        else buffer += MARK_FG_RESET;
+    }
+    if (to.bg != from.bg)
+    {
+        buffer += MARK_BG;
+        buffer += (to.bg ? to.bg : '0');
+    }
+}
+
+// Adds a single word to the output buffer, starting a new line first if it won't fit on this one.
+void add_word(const string &word, unsigned int word_width, unsigned int console_width)
+{
+    if (!word.size()) return;
+    if (console_width && output_column && output_column + word_width > console_width && word_width <= console_width)
+    {
+        output_buffer += '\n';
+        output_column = 0;
+    }
+    if (!console_width || output_column + word_width <= console_width)
+    {
+        output_buffer += word;
+        output_column += word_width;
+        return;
+    }
+
+    // The word is so long it can't be word-wrapped and is gonna split in half no matter what we do, so it's broken wherever it reaches the edge. It's only
+    // ever broken between whole characters, and a wide character that won't fit on the end of the line goes onto the next one.
+    for (size_t i = 0; i < word.size();)
+    {
+        const char ch = word[i];
+        if (ch == MARK_FG || ch == MARK_BG || ch == MARK_FG_RESET)
+        {
+            const size_t mark_length = (ch == MARK_FG_RESET ? 1 : 2);
+            output_buffer.append(word, i, mark_length);
+            i += mark_length;
+            continue;
+        }
+        const size_t char_start = i;
+        const unsigned int char_width = utf8::codepoint_width(utf8::decode(word, i));
+        if (char_width && output_column + char_width > console_width)
+        {
+            output_buffer += '\n';
+            output_column = 0;
+        }
+        output_column += char_width;
+        output_buffer.append(word, char_start, i - char_start);
+    }
+}
+
+// Adds text to the output buffer for scripts and bots to read, without any colour tags or word-wrapping.
+void print_headless(const StyledText &text, bool newline)
+{
+    string &line = (output_mode_ == Output::JSON ? json_line : output_buffer);
+    for (auto &span : text.spans())
+        if (span.type == StyledText::SpanType::TEXT) line += text.view(span);
+    if (!newline) return;
+    if (output_mode_ == Output::PLAIN) output_buffer += '\n';
+    else
+    {
+        output_buffer += "{\"type\":\"text\",\"text\":";
+        strx::json_quote(json_line, output_buffer);
+        output_buffer += "}\n";
+        json_line.clear();
+    }
+}
+
+// Asks the console how wide it is, falling back to a standard width if it can't tell us.
+unsigned int probe_width()
+{
+#ifdef WESTGATE_TARGET_WINDOWS
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return FALLBACK_WIDTH;
+    return csbi.srWindow.Right - csbi.srWindow.Left + 1;
+#else
+    winsize w{};
+    if (!isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == -1 || !w.ws_col) return FALLBACK_WIDTH;
+    return w.ws_col;
+#endif
+}
+
+// Applies a colour change from the output buffer to the console.
+void apply_colour(char mark, char colour)
+{
+    if (mark == MARK_FG) switch(colour)
+    {
+        case 'k': cout << rang::fg::black; break;
+        case 'r': cout << rang::fg::red; break;
+        case 'g': cout << rang::fg::green; break;
+        case 'y': cout << rang::fg::yellow; break;
+        case 'b': cout << rang::fg::blue; break;
+        case 'm': cout << rang::fg::magenta; break;
+        case 'c': cout << rang::fg::cyan; break;
+        case 'w': cout << rang::fg::gray; break;
+        case 'K': cout << rang::fgB::black; break;
+        case 'R': cout << rang::fgB::red; break;
+        case 'G': cout << rang::fgB::green; break;
+        case 'Y': cout << rang::fgB::yellow; break;
+        case 'B': cout << rang::fgB::blue; break;
+        case 'M': cout << rang::fgB::magenta; break;
+        case 'C': cout << rang::fgB::cyan; break;
+        case 'W': cout << rang::fgB::gray; break;
+        case '0': cout << rang::style::reset; break;
+    }
+    else switch(colour)
+    {
+        case 'k': cout << rang::bg::black; break;
+        case 'r': cout << rang::bg::red; break;
+        case 'g': cout << rang::bg::green; break;
+        case 'y': cout << rang::bg::yellow; break;
+        case 'b': cout << rang::bg::blue; break;
+        case 'm': cout << rang::bg::magenta; break;
+        case 'c': cout << rang::bg::cyan; break;
+        case 'w': cout << rang::bg::gray; break;
+        case 'K': cout << rang::bgB::black; break;
+        case 'R': cout << rang::bgB::red; break;
+        case 'G': cout << rang::bgB::green; break;
+        case 'Y': cout << rang::bgB::yellow; break;
+        case 'B': cout << rang::bgB::blue; break;
+        case 'M': cout << rang::bgB::magenta; break;
+        case 'C': cout << rang::bgB::cyan; break;
+        case 'W': cout << rang::bgB::gray; break;
+        case '0': cout << rang::bg::reset; break;
+    }
+}
+
+// Adds a character the player typed to the typeahead buffer, handling backspace as the terminal would have.
+void add_typeahead(char ch)
+{
+    if (ch == '\b' || ch == 127)
+    {
+        // A multi-byte UTF-8 character is erased all at once: any continuation bytes, and then the byte which started it.
+        if (!typeahead.size() || typeahead.back() == '\n') return;
+        while (typeahead.size() > 1 && (typeahead.back() & 0xC0) == 0x80) typeahead.pop_back();
+        typeahead.pop_back();
+    }
+    else typeahead += (ch == '\r' ? '\n' : ch);
+}
+
+#ifndef WESTGATE_TARGET_WINDOWS
+// Reads whatever is waiting in the terminal into the typeahead buffer, without waiting for more, using the specified non-canonical terminal mode.
+void read_pending(struct termios mode)
+{
+    // Anything left behind when the terminal goes back to canonical mode would become readable as if it were a whole line, so it all has to be taken now.
+    mode.c_cc[VMIN] = 0;
+    mode.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+    char ch;
+    while (read(STDIN_FILENO, &ch, 1) == 1)
+        add_typeahead(ch);
+}
+
+// Moves anything the player has typed, including half-finished lines, from the terminal into the typeahead buffer.
+void drain_typeahead()
+{
+    struct termios oldt{}, newt{};
+    tcgetattr(STDIN_FILENO, &oldt);
+    newt = oldt;
+    newt.c_lflag &= ~(ICANON | ECHO);
+    read_pending(newt);
+    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+}
+#endif
+
+// If the input prompt is on the screen, clears it away so that something else can be printed in its place.
+void clear_prompt()
+{
+    if (!prompt_shown) return;
+    prompt_shown = false;
+    if (output_mode_ != Output::CONSOLE) return;
+    output_buffer += MARK_FG;
+    output_buffer += '0';
+#ifdef WESTGATE_TARGET_WINDOWS
+    output_buffer += '\n';
+#else
+    // Whatever the player has typed so far is kept, and shown again when the prompt is.
+    drain_typeahead();
+    output_buffer += "\r\033[K";
+#endif
+    output_column = 0;
+}
+
+// Writes the output buffer to the console. The caller must hold output_mutex.
+void write_output()
+{
+    size_t start = 0;
+    for (size_t i = 0; i < output_buffer.size(); i++)
+    {
+        const char ch = output_buffer[i];
+        if (ch != MARK_FG && ch != MARK_BG && ch != MARK_FG_RESET) continue;
+        cout.write(output_buffer.data() + start, i - start);
+        if (ch == MARK_FG_RESET) cout << rang::fg::reset;
+        else apply_colour(ch, output_buffer[++i]);
+        start = i + 1;
+    }
+    cout.write(output_buffer.data() + start, output_buffer.size() - start);
+    cout.flush();
+    output_buffer.clear();
+}
+
+#ifdef WESTGATE_TARGET_WINDOWS
+// Adds a character typed into the console to the typeahead buffer, and echoes it, as the console would have done if it were reading a whole line itself.
+void add_console_char(char32_t cp)
+{
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    if (cp == '\r' || cp == '\n')
+    {
+        add_typeahead('\r');
+        output_buffer += '\n';
+        output_column = 0;
+    }
+    else if (cp == '\b')
+    {
+        if (!typeahead.size() || typeahead.back() == '\n') return;
+        size_t last_char = typeahead.size() - 1;
+        while (last_char && (typeahead[last_char] & 0xC0) == 0x80) last_char--;
+        const unsigned int width = static_cast<unsigned int>(utf8::width(string_view{typeahead}.substr(last_char)));
+        add_typeahead('\b');
+        for (unsigned int i = 0; i < width; i++)
+            output_buffer += "\b \b";
+        output_column = (output_column > width ? output_column - width : 0);
+    }
+    else if (cp >= 0x20 && cp != 127)
+    {
+        // The console gives us UTF-16, which is stored as UTF-8 like everything else.
+        char bytes[4];
+        size_t length = 0;
+        if (cp < 0x80) bytes[length++] = static_cast<char>(cp);
+        else if (cp < 0x800)
+        {
+            bytes[length++] = static_cast<char>(0xC0 | (cp >> 6));
+            bytes[length++] = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            bytes[length++] = static_cast<char>(0xE0 | (cp >> 12));
+            bytes[length++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            bytes[length++] = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            bytes[length++] = static_cast<char>(0xF0 | (cp >> 18));
+            bytes[length++] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            bytes[length++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            bytes[length++] = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        for (size_t i = 0; i < length; i++)
+            add_typeahead(bytes[i]);
+        output_buffer.append(bytes, length);
+        output_column += utf8::codepoint_width(cp);
+    }
+    else return;
+    write_output();
+}
+
+// Reads any keypresses waiting in the console into the typeahead buffer, without waiting for more. Returns false if the input isn't coming from a console at
+// all, such as when it's been redirected from a file.
+bool read_console_keys()
+{
+    static char16_t high_surrogate = 0; // Characters outside the Basic Multilingual Plane arrive as two key events, the first of which is held here.
+    const HANDLE handle = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD mode = 0, waiting = 0;
+    if (!GetConsoleMode(handle, &mode)) return false;
+    INPUT_RECORD records[32];
+    while (GetNumberOfConsoleInputEvents(handle, &waiting) && waiting)
+    {
+        DWORD count = 0;
+        if (!ReadConsoleInputW(handle, records, 32, &count) || !count) break;
+        for (DWORD i = 0; i < count; i++)
+        {
+            if (records[i].EventType != KEY_EVENT) continue;
+            const KEY_EVENT_RECORD &key = records[i].Event.KeyEvent;
+            const char16_t unit = static_cast<char16_t>(key.uChar.UnicodeChar);
+            if (!key.bKeyDown || !unit) continue;
+            if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                high_surrogate = unit;
+                continue;
+            }
+            char32_t cp = unit;
+            if (unit >= 0xDC00 && unit <= 0xDFFF)
+            {
+                if (!high_surrogate) continue;
+                cp = 0x10000 + ((static_cast<char32_t>(high_surrogate) - 0xD800) << 10) + (unit - 0xDC00);
+            }
+            high_surrogate = 0;
+            for (WORD repeat = 0; repeat < (key.wRepeatCount ? key.wRepeatCount : 1); repeat++)
+                add_console_char(cp);
+        }
+    }
+    return true;
+}
+#endif
+
+}   // anonymous namespace
+
+// Checks if the console window has changed width, and redraws anything that needs it if so.
+void check_resize()
+{
+    if (output_mode_ != Output::CONSOLE) return;
+#ifdef WESTGATE_TARGET_WINDOWS
+    resize_pending = 1; // There's no resize signal on Windows, but checking the console's size there doesn't need a round trip to the terminal.
+#endif
+    if (!resize_pending) return;
+    const unsigned int old_width = console_width;
+    if (get_width() != old_width && old_width && resize_handler) resize_handler();
+}
+
+// Tells the terminal code that something else has written to the console, so it'll check where the cursor is before printing anything more.
+void cursor_moved()
+{
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    output_column_known = false;
+}
+
+// Writes any buffered output to the console.
+void flush()
+{
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    write_output();
+}
+
 // Attempts to get the horizontal position of the 'cursor', where output is being printed. If anything goes wrong, it'll return 0.
 unsigned int get_cursor_x()
 {
+    if (output_mode_ != Output::CONSOLE) return 0;
 #ifdef WESTGATE_TARGET_WINDOWS
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return 0;  // error
     return csbi.dwCursorPosition.X;
 #else
+    // The terminal can only be asked if it's actually there to answer.
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) return 0;
     struct termios oldt{}, newt{};
     tcgetattr(STDIN_FILENO, &oldt);
     newt = oldt;
@@ -62,9 +432,22 @@ unsigned int get_cursor_x()
     std::printf("\033[6n");
     std::fflush(stdout);
 
-    // Read answer
+    // Read answer. Anything the player typed before the answer arrived is kept, to be read as input later.
+    string reply;
+    char ch;
+    while (read(STDIN_FILENO, &ch, 1) == 1)
+    {
+        if (reply.empty() && ch != '\033')
+        {
+            add_typeahead(ch);
+            continue;
+        }
+        reply += ch;
+        if (ch == 'R') break;
+    }
+    read_pending(newt);
     int row, col;
-    if (std::scanf("\033[%d;%dR", &row, &col) != 2) col = -1;
+    if (std::sscanf(reply.c_str(), "\033[%d;%dR", &row, &col) != 2) col = -1;
 
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
     return (col > 0 ? col - 1 : 0);
@@ -74,10 +457,73 @@ unsigned int get_cursor_x()
 // Prints a standard cursor and waits for non-zero input from the player.
 const string get_input()
 {
-    cout << '\n' << rang::style::reset << rang::fgB::green << "> ";
+    show_prompt();
     string input;
-    do { std::getline(std::cin, input); } while(!input.size());
-    cout << rang::style::reset;
+
+    // Scripts and bots don't type ahead or resize their windows, and when they close their end, there's nothing more to do.
+    if (output_mode_ != Output::CONSOLE)
+    {
+        do
+        {
+            if (!std::getline(std::cin, input))
+            {
+                core().log("Input stream closed, shutting down.");
+                core().destroy_core(EXIT_SUCCESS);
+            }
+        } while (!input.size());
+        std::lock_guard<std::recursive_mutex> lock(output_mutex);
+        prompt_shown = false;
+        return input;
+    }
+
+    do
+    {
+        // Any whole lines typed while the cursor position was being checked come first. A partial line is the start of the next line typed.
+        if (const size_t newline = typeahead.find('\n'); newline != string::npos)
+        {
+            input = typeahead.substr(0, newline);
+            typeahead.erase(0, newline + 1);
+#ifndef WESTGATE_TARGET_WINDOWS // On Windows, keypresses read into the typeahead buffer have already been echoed.
+            std::lock_guard<std::recursive_mutex> lock(output_mutex);
+            output_buffer += "\r\033[K> " + input + '\n';    // The terminal doesn't echo anything typed while it's being read for other reasons.
+            write_output();
+#endif
+        }
+        else
+        {
+            // Wait for a whole line to be typed. On Unix, resizing the window interrupts the wait, so anything affected can be redrawn at the new width.
+#ifdef WESTGATE_TARGET_WINDOWS
+            // On Windows, the console is read one keypress at a time into the typeahead buffer, and the line is picked up from there once Enter is pressed.
+            if (read_console_keys())
+            {
+                while (!input_pending(UINT_MAX))
+                {
+                    check_resize();
+                    show_prompt();
+                }
+                continue;
+            }
+            check_resize();
+#else
+            while (!input_pending(UINT_MAX))
+            {
+                check_resize();
+                show_prompt();
+            }
+#endif
+            std::getline(std::cin, input);
+            input = typeahead + input;
+            typeahead.clear();
+        }
+    } while(!input.size());
+
+    // The player pressing enter always leaves the cursor at the start of a new line.
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    prompt_shown = false;
+    output_buffer += MARK_FG;
+    output_buffer += '0';
+    output_column = 0;
+    output_column_known = true;
     return input;
 }
 
@@ -109,198 +555,214 @@ int get_number(int lowest, int highest, bool yes_no)
             continue;
         }
 
-        if (result < lowest || result > highest) print("{Y}Please enter a number between {R}" + to_string(lowest) + " {Y}and {R}" +
-            to_string(highest) + ".");
+        if (result < lowest || result > highest) print(Format{"{Y}Please enter a number between {R}%d {Y}and {R}%d.", lowest, highest});
         else return result;
     }
 }
 
-// Gets the width of the console window, in characters.
+// Gets the width of the console window, in characters. The console is only asked again after it's been resized, and is never asked in headless modes,
+// where this returns 0.
 unsigned int get_width()
 {
+    if (output_mode_ != Output::CONSOLE) return 0;
+    if (resize_pending)
+    {
+        resize_pending = 0;
+        console_width = probe_width();
+    }
+    return console_width;
+}
+
+// Checks if the player has typed anything which hasn't been read yet, waiting up to the specified number of milliseconds for them to do so.
+bool input_pending(unsigned int timeout_ms)
+{
+    if (typeahead.find('\n') != string::npos || std::cin.rdbuf()->in_avail() > 0) return true;
 #ifdef WESTGATE_TARGET_WINDOWS
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
-    return csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    // Keypresses are read into the typeahead buffer as they arrive, so input only counts as pending once Enter has been pressed, just as on Unix. The console
+    // handle is signalled for any input event, not just keypresses, so this can wake early; that's harmless, the caller just asks again.
+    if (!read_console_keys())
+    {
+        // Input redirected from somewhere other than a console can't be read a keypress at a time.
+        if (timeout_ms && !_kbhit()) WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), timeout_ms);
+        return _kbhit();
+    }
+    if (typeahead.find('\n') != string::npos) return true;
+    if (timeout_ms)
+    {
+        WaitForSingleObject(GetStdHandle(STD_INPUT_HANDLE), timeout_ms);
+        read_console_keys();
+    }
+    return typeahead.find('\n') != string::npos;
 #else
-    winsize w;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-    return w.ws_col;
+    // The terminal only makes input readable once a whole line has been entered. A signal, such as the window being resized, ends the wait early.
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(STDIN_FILENO, &fds);
+    timeval timeout{static_cast<time_t>(timeout_ms / 1000), static_cast<suseconds_t>((timeout_ms % 1000) * 1000)};
+    return select(STDIN_FILENO + 1, &fds, nullptr, nullptr, &timeout) > 0;
 #endif
 }
 
-// Prints a string of text with std::cout, processing ANSI colour tags.
+// Checks how output is being written.
+Output output_mode() { return output_mode_; }
+
+// Adds a string of text to the output buffer, processing ANSI colour tags. It's written to the console at the next flush().
 void print(const string_view text, bool newline)
 {
-    // Handle blank text by just printing a newline.
-    if (!text.size())
+    // Each thread parses into the same StyledText every time, so its memory is reused rather than allocated afresh for each line. Should the printing ever
+    // lead back here before it's done (it doesn't, but it would be easy to miss if it started to), a fresh StyledText is used instead.
+    static thread_local StyledText parsed;
+    static thread_local bool parsed_in_use = false;
+    if (parsed_in_use)
     {
-        if (newline) cout << '\n';
+        print(StyledText{text}, newline);
         return;
     }
+    parsed_in_use = true;
+    parsed.parse(text);
+    print(parsed, newline);
+    parsed_in_use = false;
+}
 
-    const unsigned int console_width = get_width();
-    unsigned int chars_so_far = 0;
-
-    // I KNOW THIS IS A NIGHTMARE OF CODE BUT THERE ARE SO MANY EDGE CASES :(
-    std::function<void(string, bool)> print_formatted = [&print_formatted, &console_width, &chars_so_far](const string &line, bool recalc_cursor)
+// As above, but with text that has already had its colour tags parsed.
+void print(const StyledText &text, bool newline)
+{
+    std::unique_lock<std::recursive_mutex> lock(output_mutex);
+    clear_prompt();
+    if (output_mode_ != Output::CONSOLE)
     {
-        if (!line.size()) return;
-        // This can be computationally expensive to do for every single word, especially on Unix, so we'll only check the 'cursor' position when absolutely
-        // necessary, and keep count ourselves internally for the rest of it.
-        if (recalc_cursor) chars_so_far = get_cursor_x();
-
-        // If newlines are specified, break them up and handle them with recursive calls.
-        if (auto new_line = line.find_first_of('\n');
-            new_line != string::npos)
-        {
-            const string before_newline = line.substr(0, new_line);
-            const string after_newline = line.substr(new_line + 1);
-            print_formatted(before_newline, false);
-            cout << '\n';
-            chars_so_far = 0;
-            print_formatted(after_newline, false);
-            return;
-        }
+        print_headless(text, newline);
+        return;
+    }
 
-        // If there's any spaces, print one word at a time.
-        auto space = line.find_first_of(' ');
-        if (space == string::npos) // If there aren't any spaces, just print what we have as-is.
-        {
-            if (chars_so_far + line.size() >= console_width)
-            {
-                cout << '\n';
-                chars_so_far = 0;
-            }
-            cout << line;
-            chars_so_far += line.size();
-            if (chars_so_far >= console_width) chars_so_far -= console_width;   // Make the best guess for how many characters ended up on the next line.
-            return;
-        }
-        // Split the text into whatever's before the first space, and whatever's after it. This should let us print one word at a time.
-        const string before_space = line.substr(0, space);
-        const string after_space = line.substr(space + 1);
-        bool space_after = false;
-        if (line.at(line.size() - 1) == ' ' && !after_space.size()) space_after = true;
-
-        // The current word is so long it can't be word-wrapped and is gonna split in half no matter what we do. Hnng. Okay, this is incredibly unlikely to
-        // actually happen, but we've gotta handle it just in case.
-        if (before_space.size() >= console_width)
-        {
-            int available_size = static_cast<int>(console_width) - chars_so_far;
-            const string cropped_before = before_space.substr(0, available_size);
-            cout << cropped_before << '\n';
-            chars_so_far = 0;
-            print_formatted(before_space.substr(available_size) + " " + after_space, false);
-            return;
-        }
-        if (chars_so_far + before_space.size() > console_width) // If there isn't room for this word, start a new line.
-        {
-            cout << '\n';
-            chars_so_far = 0;
-        }
-        if (after_space.size()) space_after = true;
-        cout << before_space;
-        chars_so_far += before_space.size();
-        if (chars_so_far == console_width)  // If the word *ends* at the very last column of the console window, insert a new line.
-        {
-            cout << '\n';
-            chars_so_far = 0;
-        }
-        else if (space_after)
-        {
-            cout << ' ';
-            chars_so_far++;
-        }
-        print_formatted(after_space, false);
-    };
+    // The cursor position is tracked here as text is printed, so the terminal only needs to be asked after something else has moved it.
+    if (!output_column_known)
+    {
+        write_output();
+        output_column = get_cursor_x();
+        output_column_known = true;
+    }
+    const unsigned int console_width = get_width();
 
-    string output = string{text};
+    // The text is added to the output buffer one word at a time, with any colour changes inside the word kept with it, so each word can be wrapped onto a
+    // new line if it doesn't fit on this one.
+    static const scan::ByteSet word_delimiters{" \n"};
+    static string word; // Kept between calls, so its memory is reused. The output mutex is held while it's in use.
+    word.clear();
+    unsigned int word_width = 0;
+    StyledText::Style style;
     vector<string> invalid_tags;
-    while(output.size())
+    for (auto &span : text.spans())
     {
-        auto opener_pos = output.find_first_of('{');    // Try to find an opening tag for an ANSI colour.
-        auto closer_pos = output.find_first_of('}');    // And a matching closing tag.
-        if (opener_pos == string::npos || closer_pos == string::npos) // If none are found, just print the string as-is and finish.
+        if (span.type == StyledText::SpanType::LINE_BREAK) continue;    // Line breaks are handled by StyledText::wrap(), and are ignored here.
+        if (span.type == StyledText::SpanType::INVALID_TAG)
         {
-            print_formatted(output, true);
-            break;
+            invalid_tags.push_back(string{text.view(span)});
+            continue;
         }
-
-        // Clip out the text before, during, and after the colour tag.
-        string untagged = output.substr(0, opener_pos);
-        string tag = output.substr(opener_pos + 1, closer_pos - opener_pos - 1);
-        output = output.substr(closer_pos + 1);
-
-        // Print any text before the next ANSI tag. If there's an existing tag already in play, it'll cause this text to be coloured.
-        if (untagged.size()) print_formatted(untagged, false);
-
-        // Process the ANSI codes from the tag.
-        bool invalid_tag = false;
-        if (tag.size() >= 1) switch(tag[0])
+        if (span.style != style)
         {
-            case 'k': cout << rang::fg::black; break;
-            case 'r': cout << rang::fg::red; break;
-            case 'g': cout << rang::fg::green; break;
-            case 'y': cout << rang::fg::yellow; break;
-            case 'b': cout << rang::fg::blue; break;
-            case 'm': cout << rang::fg::magenta; break;
-            case 'c': cout << rang::fg::cyan; break;
-            case 'w': cout << rang::fg::gray; break;
-            case 'K': cout << rang::fgB::black; break;
-            case 'R': cout << rang::fgB::red; break;
-            case 'G': cout << rang::fgB::green; break;
-            case 'Y': cout << rang::fgB::yellow; break;
-            case 'B': cout << rang::fgB::blue; break;
-            case 'M': cout << rang::fgB::magenta; break;
-            case 'C': cout << rang::fgB::cyan; break;
-            case 'W': cout << rang::fgB::gray; break;
-            case '0':
-                if (tag.size() >= 2) cout << rang::fg::reset;
-                else cout << rang::style::reset;
-                break;
-            default: invalid_tag = true; break;
+            add_style_change(word, style, span.style);
+            style = span.style;
         }
-        if (tag.size() >= 2) switch(tag[1])
+
+        const string_view span_text = text.view(span);
+        scan::Scanner scanner{span_text, word_delimiters};
+        const bool ascii = (scan::find_non_ascii(span_text) == string_view::npos);  // Plain ASCII is one column per byte, so words don't need measuring.
+        for (size_t pos = 0; pos < span_text.size(); pos++)
         {
-            case 'k': cout << rang::bg::black; break;
-            case 'r': cout << rang::bg::red; break;
-            case 'g': cout << rang::bg::green; break;
-            case 'y': cout << rang::bg::yellow; break;
-            case 'b': cout << rang::bg::blue; break;
-            case 'm': cout << rang::bg::magenta; break;
-            case 'c': cout << rang::bg::cyan; break;
-            case 'w': cout << rang::bg::gray; break;
-            case 'K': cout << rang::bgB::black; break;
-            case 'R': cout << rang::bgB::red; break;
-            case 'G': cout << rang::bgB::green; break;
-            case 'Y': cout << rang::bgB::yellow; break;
-            case 'B': cout << rang::bgB::blue; break;
-            case 'M': cout << rang::bgB::magenta; break;
-            case 'C': cout << rang::bgB::cyan; break;
-            case 'W': cout << rang::bgB::gray; break;
-            case '0': cout << rang::bg::reset; break;
-            default: invalid_tag = true; break;
+            // Everything up to the next space or newline is part of the current word.
+            const size_t word_end = std::min(scanner.next(pos), span_text.size());
+            word.append(span_text, pos, word_end - pos);
+            word_width += static_cast<unsigned int>(ascii ? word_end - pos : utf8::width(span_text.substr(pos, word_end - pos)));
+            pos = word_end;
+            if (pos >= span_text.size()) break;
+
+            const char ch = span_text[pos];
+            add_word(word, word_width, console_width);
+            word.clear();
+            word_width = 0;
+            if (ch == '\n')
+            {
+                output_buffer += '\n';
+                output_column = 0;
+            }
+            else if (!console_width || output_column < console_width)  // Spaces which would fall off the end of the line are dropped.
+            {
+                output_buffer += ' ';
+                output_column++;
+            }
         }
-        if (tag.size() > 2 || !tag.size()) invalid_tag = true;
-        if (!tag.compare("nl")) invalid_tag = false;
-        if (invalid_tag) invalid_tags.push_back(tag);
     }
+    add_word(word, word_width, console_width);
 
-    if (newline) cout << rang::style::reset << '\n';   // Reset any ANSI tags and end the line, if requested.
+    if (newline)    // Reset any ANSI tags and end the line, if requested.
+    {
+        output_buffer += MARK_FG;
+        output_buffer += "0\n";
+        output_column = 0;
+    }
 
+    // Core takes its own lock while logging, and may flush the output buffer while holding it, so ours has to be released first.
+    lock.unlock();
     for (auto tag : invalid_tags)
-        core().nonfatal("Invalid colour tag: {" + tag + "}", Core::CORE_WARN);
+        core().nonfatal("Invalid colour tag: " + tag, Core::CORE_WARN);
+}
+
+// Writes a JSON event on a line of its own. Does nothing unless the output mode is JSON.
+void print_json(const string_view json)
+{
+    if (output_mode_ != Output::JSON) return;
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    clear_prompt();
+    output_buffer += json;
+    output_buffer += '\n';
 }
 
+// Sets how output is written.
+void set_output_mode(Output mode) { output_mode_ = mode; }
+
+// Sets the function to call when the console window changes width.
+void set_resize_handler(std::function<void()> handler) { resize_handler = std::move(handler); }
+
 // Attempts to set the title of the console window. May not work on all platforms.
 void set_window_title(const string_view new_title)
 {
+    if (output_mode_ != Output::CONSOLE) return;
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
 #ifdef WESTGATE_TARGET_WINDOWS
+    write_output();
     SetConsoleTitleA(string{new_title}.c_str());
 #else
-    cout << "\033]2;" << new_title << "\007" << std::flush;
+    output_buffer += "\033]2;" + string{new_title} + "\007";
+    write_output();
 #endif
 }
 
+// Prints the standard input prompt, along with anything the player has already started typing, unless it's already on the screen.
+void show_prompt()
+{
+    std::lock_guard<std::recursive_mutex> lock(output_mutex);
+    if (output_mode_ != Output::CONSOLE)
+    {
+        if (!prompt_shown && output_mode_ == Output::JSON) output_buffer += "{\"type\":\"prompt\"}\n";
+        prompt_shown = true;
+    }
+    else if (!prompt_shown)
+    {
+        prompt_shown = true;
+        output_buffer += string{"\n"} + MARK_FG + '0' + MARK_FG + "G> ";
+        output_column = 2;
+        if (typeahead.find('\n') == string::npos)
+        {
+            output_buffer += typeahead;
+            output_column += static_cast<unsigned int>(utf8::width(typeahead));
+        }
+    }
+    write_output();
+}
+
+// Called when the console window is resized. This is a signal handler, so all it does is note that the width needs checking again.
+void window_resized(int) { resize_pending = 1; }
+
 } } // namespace terminal, westgate
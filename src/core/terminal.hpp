@@ -19,15 +19,35 @@
 #pragma once
 #include "core/pch.hpp" // Precompiled header
 
+#include <functional>
+
 namespace westgate {
+
+class StyledText;   // defined in util/styled-text.hpp
+
 namespace terminal {
 
+// How output is written: to an interactive console, or as plain text or newline-delimited JSON events for scripts and bots to read.
+enum class Output : uint8_t { CONSOLE, PLAIN, JSON };
+
+void                check_resize(); // Checks if the console window has changed width, and redraws anything that needs it if so.
+void                cursor_moved(); // Tells the terminal code that something else has written to the console, so it'll check where the cursor is.
+void                flush();        // Writes any buffered output to the console.
 unsigned int        get_cursor_x(); // Attempts to get the horizontal position of the 'cursor', where output is being printed.
 const std::string   get_input();    // Prints a standard cursor and waits for non-zero input from the player.
                     // As with get_input(), but requires the user to enter an integer number. If yes_no is true, it allows yes/no to translate to 1/0.
 int                 get_number(int lowest = INT_MIN, int highest = INT_MAX, bool yes_no = false);
-unsigned int        get_width();    // Gets the width of the console window, in characters. If anything goes wrong, it'll return 0.
-void                print(const std::string_view text = "", bool newline = true);   // Prints a string of text with std::cout, processing ANSI colour tags.
+unsigned int        get_width();    // Gets the width of the console window, in characters. The console is only asked again after it's been resized.
+bool                input_pending(unsigned int timeout_ms = 0); // Checks if the player has typed anything which hasn't been read yet, waiting up to timeout_ms.
+Output              output_mode();  // Checks how output is being written.
+                    // Adds a string of text to the output buffer, processing ANSI colour tags. It's written to the console at the next flush().
+void                print(const std::string_view text = "", bool newline = true);
+void                print(const StyledText &text, bool newline = true); // As above, but with text that has already had its colour tags parsed.
+void                print_json(const std::string_view json);   // Writes a JSON event on a line of its own. Does nothing unless the output mode is JSON.
+void                set_output_mode(Output mode);   // Sets how output is written.
+void                set_resize_handler(std::function<void()> handler);  // Sets the function to call when the console window changes width.
 void                set_window_title(const std::string_view new_title); // Attempts to set the title of the console window. May not work on all platforms.
+void                show_prompt();  // Prints the standard input prompt, unless it's already on the screen.
+void                window_resized(int);    // Called when the console window is resized.
 
 } } // namespace terminal, westgate
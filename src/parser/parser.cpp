@@ -52,7 +52,12 @@ static const std::map<hash_wg, Direction> parser_directions = {
 };
 
 static const std::unordered_map<hash_wg, std::function<void(vector<hash_wg>&, vector<string>&)>> parser_verbs = {
+#ifdef WESTGATE_BUILD_DEBUG
+    { 3728989739, actions::cheats::allocs },                // #allocs
+#endif
     { 2252282012, actions::cheats::hash },                  // #hash
+    { 4101471888, actions::cheats::look_stats },            // #lookstats
+    { 1710136024, actions::cheats::reload },                // #reload
     { 3069208872, actions::meta::automap },                 // automap
     { 2746646486, actions::world_interaction::open_close }, // close
     { 2573673949, actions::world_interaction::travel },     // d
@@ -0,0 +1,180 @@
+// tools/datagen.cpp -- Build-time tool which converts static gamedata files (weather strings, name lists, etc.) into a C++ source file that can be compiled
+// directly into the game binary, so the game doesn't have to parse them every time it starts. Run automatically by CMake; see util/static-data.hpp.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "util/filex.hpp"
+#include "util/strx.hpp"
+#include "util/yaml.hpp"
+
+using namespace westgate;
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+
+namespace {
+
+// Converts a string into an escaped C++ string literal.
+string literal(const string_view str)
+{
+    string out = "\"";
+    for (const char ch : str)
+    {
+        if (ch == '"' || ch == '\\') out += string("\\") + ch;
+        else if (ch >= 32 && ch < 127) out += ch;
+        else
+        {
+            // Always use three octal digits, so the escape can't swallow any digits following it.
+            char octal[5];
+            std::snprintf(octal, sizeof(octal), "\\%03o", static_cast<unsigned char>(ch));
+            out += octal;
+        }
+    }
+    return out + "\"";
+}
+
+// Writes a sequence of strings as a StringList, packed into a single string with an array of offsets.
+void write_list(std::ostream &out, const string_view name, const vector<string> &vec)
+{
+    if (vec.empty()) throw runtime_error(string{name} + ": Empty data array");
+    string offsets = "0";
+    uint32_t offset = 0;
+    out << "namespace { constexpr uint32_t " << name << "_offsets[] = { ";
+    for (auto &str : vec)
+    {
+        offset += str.size();
+        offsets += ", " + to_string(offset);
+    }
+    out << offsets << " }; }\nconstexpr StringList " << name << " = {\n";
+    for (auto &str : vec)
+        out << "    " << literal(str) << "\n";
+    out << "    , " << name << "_offsets, " << vec.size() << " };\n\n";
+}
+
+// Writes the hash of a data file, so the game can tell if the file has been modified after the build.
+void write_hash(std::ostream &out, const string_view name, const string_view filename)
+{
+    out << "const hash_wg " << name << "_hash = " << to_string(strx::murmur3(filex::file_to_string(filename))) << "u;\n";
+}
+
+// Writes out the data from misc/weather.yml
+void write_weather(std::ostream &out, const string &data_dir)
+{
+    const string filename = data_dir + "/misc/weather.yml";
+    YAML yaml(filename);
+    if (!yaml.is_map()) throw runtime_error("weather.yml file is invalid!");
+    auto key_vals = yaml.keys_vals();   // This is a std::map, so the keys are already sorted.
+    vector<std::pair<string, string>> weather_maps;
+
+    out << "// misc/weather.yml\n";
+    write_hash(out, "weather_yml", filename);
+    out << "constexpr KeyVal weather_strings[] = {\n";
+    for (auto &key_val : key_vals)
+    {
+        // Weather maps are either WMAP0 - WMAP8 for the default climate, or CLIMATE_WMAP0 - CLIMATE_WMAP8 for any other climate.
+        const string &key = key_val.first;
+        if (key.size() >= 5 && !key.compare(key.size() - 5, 4, "WMAP") && (key.size() == 5 || key.at(key.size() - 6) == '_'))
+        {
+            const int map_id = key.back() - '0';
+            if (map_id < 0 || map_id > 8) throw runtime_error("Invalid weather map strings.");
+            weather_maps.push_back({key, strx::decode_compressed_string(key_val.second)});
+        }
+        else out << "    { " << literal(key) << ", " << literal(key_val.second) << " },\n";
+    }
+    out << "};\nconst size_t weather_strings_size = std::size(weather_strings);\n";
+
+    if (weather_maps.empty()) throw runtime_error("Missing weather map strings.");
+    out << "constexpr KeyVal weather_maps[] = {\n";
+    for (auto &weather_map : weather_maps)
+        out << "    { " << literal(weather_map.first) << ", " << literal(weather_map.second) << " },\n";
+    out << "};\nconst size_t weather_maps_size = std::size(weather_maps);\n\n";
+}
+
+// Writes out the data from namegen/namegen-strings.yml
+void write_namegen_strings(std::ostream &out, const string &data_dir)
+{
+    const string filename = data_dir + "/namegen/namegen-strings.yml";
+    YAML yaml(filename);
+    if (!yaml.is_map()) throw runtime_error("namegen-strings.yml: Invalid file format");
+    for (auto key : { "consonant_block", "vowel_block", "v4_template" })
+        if (!yaml.key_exists(key)) throw runtime_error(string("namegen-strings.yml: ") + key + " missing");
+
+    out << "// namegen/namegen-strings.yml\n";
+    write_hash(out, "namegen_strings_yml", filename);
+    out << "constexpr std::string_view namegen_consonant_block = " << literal(strx::decode_compressed_string(yaml.val("consonant_block"))) << ";\n";
+    out << "constexpr std::string_view namegen_v4_template = " << literal(yaml.val("v4_template")) << ";\n";
+    out << "constexpr std::string_view namegen_vowel_block = " << literal(strx::decode_compressed_string(yaml.val("vowel_block"))) << ";\n\n";
+    for (auto key : { "c", "d", "e", "f", "i", "k", "v", "x" })
+        write_list(out, string("namegen_pv3_") + key, yaml.get_seq(string("pv3_") + key));
+}
+
+// Writes out one of the namegen/*.txt name lists.
+void write_name_list(std::ostream &out, const string &data_dir, const string_view list_name, const string_view file)
+{
+    const string filename = data_dir + "/namegen/" + string{file} + ".txt";
+    const vector<string> names = filex::file_to_vec(filename, filex::FTV_FLAG_IGNORE_BLANK_LINES | filex::FTV_FLAG_IGNORE_COMMENTS);
+
+    out << "// namegen/" << file << ".txt\n";
+    write_hash(out, string{list_name} + "_txt", filename);
+    write_list(out, list_name, names);
+}
+
+}   // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: westgate-datagen <gamedata folder> <output file>\n";
+        return EXIT_FAILURE;
+    }
+    const string data_dir = argv[1];
+
+    try
+    {
+        std::stringstream out;
+        out << "// Generated by tools/datagen.cpp from the files in the gamedata folder. Do not edit this file directly.\n\n";
+        out << "#include <iterator>\n\n#include \"util/static-data.hpp\"\n\nnamespace westgate::static_data {\n\n";
+        write_weather(out, data_dir);
+        write_namegen_strings(out, data_dir);
+        write_name_list(out, data_dir, "names_f", "names-f");
+        write_name_list(out, data_dir, "names_m", "names-m");
+        write_name_list(out, data_dir, "surname_a", "surname-a");
+        write_name_list(out, data_dir, "surname_b", "surname-b");
+        out << "}   // namespace westgate::static_data\n";
+
+        std::ofstream file(argv[2], std::ios::out | std::ios::trunc);
+        if (!file.is_open()) throw runtime_error("Cannot write to file: " + string(argv[2]));
+        file << out.str();
+        file.close();
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "westgate-datagen: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
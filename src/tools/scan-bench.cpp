@@ -0,0 +1,302 @@
+// tools/scan-bench.cpp -- Randomized check and micro-benchmark for the delimiter-scanning kernels in util/scan, and the strx and utf8 functions built on
+// them. Each kernel this CPU supports is checked against a plain byte-by-byte scan, the strx functions against the code they replaced, and the utf8 functions
+// against a plain one-character-at-a-time version, before anything is timed.
+// Not built by default; build it with the westgate-scan-bench target.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/scan.hpp"
+#include "util/strx.hpp"
+#include "util/utf8.hpp"
+
+using namespace westgate;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+
+// The bytes random test strings are made from. Mostly delimiters, so there's plenty for the kernels to find, plus a few bytes with the high bit set.
+constexpr string_view   TEST_BYTES =    "aaaabbbcc    [[]]{{}}::\n\t\x80\xff";
+// Conditional tags, dropped into the random strings so process_conditional_tags() has something to do. Tags without a colon are left out, as an active
+// one like [day] can make the old code (and the new) loop forever.
+constexpr string_view   TEST_TAGS[] =   { "[day:", "[daydawn:", "[night:", "[dawn:", "[nightdusk:" };
+// UTF-8 characters, dropped into the random strings for the utf8 functions: accented, combining, wide, four-byte and zero-width ones, and a few which aren't
+// valid UTF-8 at all (an overlong encoding, a surrogate, and one cut short).
+constexpr string_view   TEST_UTF8[] =   { "\xC3\xA9", "\xCC\x81", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80", "\xE2\x80\x8B", "\xEF\xBC\xA1", "\xC0\xAF",
+    "\xED\xA0\x80", "\xE4\xB8" };
+
+const vector<scan::Kernel>  ALL_KERNELS = { scan::Kernel::SCALAR, scan::Kernel::SSE2, scan::Kernel::AVX2 };
+
+std::mt19937_64 rng(0x5745535447415445ULL);   // Fixed seed, so any failure can be repeated.
+
+// Replaces every instance of one string with another, as the old code did it.
+bool legacy_find_and_replace(string& input, const string_view to_find, const string_view to_replace)
+{
+    string::size_type pos = 0;
+    const string::size_type find_len = to_find.length(), replace_len = to_replace.length();
+    if (find_len == 0) return false;
+    bool found = false;
+    while ((pos = input.find(to_find, pos)) != string::npos)
+    {
+        found = true;
+        input.replace(pos, find_len, to_replace);
+        pos += replace_len;
+    }
+    return found;
+}
+
+// Handles conditional tags, as the old code did it.
+void legacy_process_conditional_tags(string& str, const string_view tag, bool active)
+{
+    string tag_str = string{tag};
+    do
+    {
+        const size_t start = str.find("[" + tag_str);
+        const size_t end = str.find("]", start);
+        if (start == string::npos || end == string::npos) return;
+        if (active)
+        {
+            const size_t insert_start = start + tag.size() + 2;
+            const string insert = str.substr(insert_start, end - insert_start);
+            str = str.substr(0, start) + insert + str.substr(end + 1);
+        }
+        else str = str.substr(0, start) + str.substr(end + 1);
+    } while(true);
+}
+
+// Splits a string, as the old code did it.
+vector<string> legacy_string_explode(const string_view str, const string_view separator)
+{
+    vector<string> results;
+
+    string::size_type pos = str.find(separator, 0);
+    const size_t pit = separator.length();
+    string line = string{str};
+
+    while(pos != string::npos)
+    {
+        if (pos == 0) results.push_back("");
+        else results.push_back(line.substr(0, pos));
+        line.erase(0, pos + pit);
+        pos = line.find(separator, 0);
+    }
+    results.push_back(line);
+
+    return results;
+}
+
+// Returns a random number from 0 to max, inclusive.
+size_t random_below(size_t max) { return std::uniform_int_distribution<size_t>(0, max)(rng); }
+
+// Makes a random string of up to max_length bytes.
+string random_string(size_t max_length)
+{
+    const size_t length = random_below(max_length);
+    string result;
+    result.reserve(length + 10);
+    while (result.size() < length)
+    {
+        if (!random_below(15)) result += TEST_TAGS[random_below(std::size(TEST_TAGS) - 1)];
+        else if (!random_below(10)) result += TEST_UTF8[random_below(std::size(TEST_UTF8) - 1)];
+        else result += TEST_BYTES[random_below(TEST_BYTES.size() - 1)];
+    }
+    return result;
+}
+
+// Checks if a string is valid UTF-8, going by the table of well-formed byte sequences in the Unicode standard.
+bool reference_valid(string_view str)
+{
+    auto in = [](char ch, int low, int high) { return static_cast<unsigned char>(ch) >= low && static_cast<unsigned char>(ch) <= high; };
+    for (size_t i = 0; i < str.size();)
+    {
+        const size_t left = str.size() - i;
+        if (in(str[i], 0x00, 0x7F)) i += 1;
+        else if (in(str[i], 0xC2, 0xDF) && left >= 2 && in(str[i + 1], 0x80, 0xBF)) i += 2;
+        else if (left >= 3 && ((in(str[i], 0xE0, 0xE0) && in(str[i + 1], 0xA0, 0xBF)) || (in(str[i], 0xE1, 0xEC) && in(str[i + 1], 0x80, 0xBF)) ||
+            (in(str[i], 0xED, 0xED) && in(str[i + 1], 0x80, 0x9F)) || (in(str[i], 0xEE, 0xEF) && in(str[i + 1], 0x80, 0xBF))) &&
+            in(str[i + 2], 0x80, 0xBF)) i += 3;
+        else if (left >= 4 && ((in(str[i], 0xF0, 0xF0) && in(str[i + 1], 0x90, 0xBF)) || (in(str[i], 0xF1, 0xF3) && in(str[i + 1], 0x80, 0xBF)) ||
+            (in(str[i], 0xF4, 0xF4) && in(str[i + 1], 0x80, 0x8F))) && in(str[i + 2], 0x80, 0xBF) && in(str[i + 3], 0x80, 0xBF)) i += 4;
+        else return false;
+    }
+    return true;
+}
+
+// Measures a string one character at a time, without skipping over plain ASCII, to check utf8::width() against.
+size_t reference_width(string_view str)
+{
+    size_t width = 0;
+    for (size_t pos = 0; pos < str.size();)
+        width += utf8::codepoint_width(utf8::decode(str, pos));
+    return width;
+}
+
+// Scans a block one byte at a time, with nothing clever at all, to check the kernels against.
+uint64_t reference_scan(const char* data, size_t length, string_view set)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < std::min(length, scan::BLOCK_SIZE); i++)
+        if (set.find(data[i]) != string_view::npos) mask |= 1ULL << i;
+    return mask;
+}
+
+// Checks each kernel, and the strx functions, against the scalar versions. Returns how many mismatches were found.
+int check(int rounds)
+{
+    int failures = 0;
+    auto fail = [&failures](const char* what, const string &input)
+    {
+        if (++failures <= 10) std::printf("MISMATCH in %s, on input: \"%s\"\n", what, input.c_str());
+    };
+
+    for (int round = 0; round < rounds; round++)
+    {
+        // Scanning, with each kernel, at every alignment within the string.
+        const string str = random_string(200);
+        const string set_str = random_string(scan::MAX_BYTES).substr(0, scan::MAX_BYTES);
+        const scan::ByteSet set{set_str};
+        scan::Scanner scanner{str, set}, random_scanner{str, set};
+        for (size_t offset = 0; offset <= str.size(); offset++)
+        {
+            const uint64_t expected = reference_scan(str.data() + offset, str.size() - offset, set_str);
+            for (auto kernel : ALL_KERNELS)
+                if (scan::kernel_supported(kernel) && scan::scan_block(str.data() + offset, str.size() - offset, set, kernel) != expected)
+                    fail(scan::kernel_name(kernel), str);
+            uint64_t expected_non_ascii = 0;
+            for (size_t i = 0; i < std::min(str.size() - offset, scan::BLOCK_SIZE); i++)
+                if (static_cast<unsigned char>(str[offset + i]) >= 0x80) expected_non_ascii |= 1ULL << i;
+            for (auto kernel : ALL_KERNELS)
+                if (scan::kernel_supported(kernel) && scan::scan_non_ascii(str.data() + offset, str.size() - offset, kernel) != expected_non_ascii)
+                    fail((string{scan::kernel_name(kernel)} + " (non-ASCII)").c_str(), str);
+            const size_t expected_pos = (set_str.empty() ? string::npos : str.find_first_of(set_str, offset));
+            if (scan::find_first_of(str, set, offset) != expected_pos) fail("find_first_of()", str);
+            if (scanner.next(offset) != expected_pos) fail("Scanner", str);
+
+            // The scanner should cope with jumping backwards and forwards too.
+            const size_t random_pos = random_below(str.size());
+            if (random_scanner.next(random_pos) != (set_str.empty() ? string::npos : str.find_first_of(set_str, random_pos)))
+                fail("Scanner (random positions)", str);
+        }
+
+        // Measuring and validating UTF-8, from every starting point so that some strings begin partway through a character.
+        for (size_t offset = 0; offset <= str.size(); offset++)
+        {
+            const string_view tail = string_view{str}.substr(offset);
+            if (utf8::width(tail) != reference_width(tail)) fail("utf8::width()", str);
+            if (utf8::valid(tail) != reference_valid(tail)) fail("utf8::valid()", str);
+        }
+
+        // Searching for strings.
+        const string to_find = random_string(4);
+        for (size_t offset = 0; offset <= str.size() + 1; offset++)
+            if (scan::find_string(str, to_find, offset) != str.find(to_find, offset)) fail("find_string()", str);
+
+        // The strx functions built on the kernels.
+        if (strx::string_explode(str, to_find) != (to_find.empty() ? vector<string>{str} : legacy_string_explode(str, to_find)))
+            fail("string_explode()", str);
+        const string to_replace = random_string(6);
+        string replaced = str, legacy_replaced = str;
+        if (strx::find_and_replace(replaced, to_find, to_replace) != legacy_find_and_replace(legacy_replaced, to_find, to_replace) ||
+            replaced != legacy_replaced) fail("find_and_replace()", str);
+        for (auto tag : { "day", "night", "dawn" })
+        {
+            for (bool active : { true, false })
+            {
+                string processed = str, legacy_processed = str;
+                bool threw = false, legacy_threw = false;
+                try { strx::process_conditional_tags(processed, tag, active); } catch (std::out_of_range&) { threw = true; }
+                try { legacy_process_conditional_tags(legacy_processed, tag, active); } catch (std::out_of_range&) { legacy_threw = true; }
+                if (threw != legacy_threw || (!threw && processed != legacy_processed)) fail("process_conditional_tags()", str);
+            }
+        }
+    }
+    return failures;
+}
+
+// Runs a function over and over, and returns how many nanoseconds each run took on average.
+template<typename F> double time_runs(int runs, F func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++)
+        func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+}   // anonymous namespace
+
+// Main program entry point.
+int main(int argc, char** argv)
+{
+    const int runs = (argc > 1 ? std::stoi(argv[1]) : 20000);
+    const int failures = check(2000);
+    std::printf("Best kernel: %s. Randomized check: %s\n\n", scan::kernel_name(scan::best_kernel()),
+        (failures ? (std::to_string(failures) + " mismatches!").c_str() : "all kernels match."));
+
+    // A long room description with the delimiters spread thinly through it, which is where the wider kernels should pull ahead.
+    string text;
+    for (int i = 0; i < 40; i++)
+        text += "The warped wooden floorboards creak in protest as you step into an inn that has seen better days, the scents of sweat and stale beer hanging "
+            "in the air. [day:Sunlight filters in through dusty, cracked windows.][night:Lanterns flicker against the dark windows.] {nl}";
+    const scan::ByteSet set{"[]{}"};
+    size_t checksum = 0;    // Stops the compiler from optimizing the benchmarks away.
+
+    std::printf("%-34s%14s\n", ("Scanning " + std::to_string(text.size()) + " chars").c_str(), "Time (ns)");
+    const double std_ns = time_runs(runs, [&] {
+        for (size_t pos = text.find_first_of("[]{}"); pos != string::npos; pos = text.find_first_of("[]{}", pos + 1)) checksum += pos; });
+    std::printf("%-34s%14.0f\n", "std::string::find_first_of()", std_ns);
+    for (auto kernel : ALL_KERNELS)
+    {
+        if (!scan::kernel_supported(kernel)) continue;
+        const double ns = time_runs(runs, [&] {
+            for (size_t pos = 0; pos < text.size(); pos += scan::BLOCK_SIZE)
+                for (uint64_t mask = scan::scan_block(text.data() + pos, text.size() - pos, set, kernel); mask; mask &= mask - 1) checksum += pos; });
+        std::printf("%-34s%14.0f\n", (string{scan::kernel_name(kernel)} + " kernel").c_str(), ns);
+    }
+
+    std::printf("\n%-34s%14s%14s\n", "Function", "Old (ns)", "New (ns)");
+    const int slow_runs = std::max(1, runs / 20);
+    auto compare = [&](const char* name, auto old_func, auto new_func)
+        { std::printf("%-34s%14.0f%14.0f\n", name, time_runs(slow_runs, old_func), time_runs(slow_runs, new_func)); };
+    compare("string_explode()", [&] { checksum += legacy_string_explode(text, " ").size(); }, [&] { checksum += strx::string_explode(text, " ").size(); });
+    compare("find_and_replace()", [&] { string str = text; checksum += legacy_find_and_replace(str, "wooden", "oak"); },
+        [&] { string str = text; checksum += strx::find_and_replace(str, "wooden", "oak"); });
+    compare("process_conditional_tags()", [&] { string str = text; legacy_process_conditional_tags(str, "day", true); checksum += str.size(); },
+        [&] { string str = text; strx::process_conditional_tags(str, "day", true); checksum += str.size(); });
+
+    // Measuring and validating text, both plain ASCII and with accented letters scattered through it, against going one character at a time.
+    string accented = text;
+    for (size_t pos = 0; (pos = accented.find("e ", pos)) != string::npos; pos += 3)
+        accented.replace(pos, 1, "\xC3\xA9");
+    std::printf("\n%-34s%14s%14s\n", "UTF-8", "Per-char (ns)", "utf8 (ns)");
+    compare("width(), ASCII text", [&] { checksum += reference_width(text); }, [&] { checksum += utf8::width(text); });
+    compare("width(), accented text", [&] { checksum += reference_width(accented); }, [&] { checksum += utf8::width(accented); });
+    compare("valid(), ASCII text", [&] { checksum += reference_valid(text); }, [&] { checksum += utf8::valid(text); });
+    compare("valid(), accented text", [&] { checksum += reference_valid(accented); }, [&] { checksum += utf8::valid(accented); });
+
+    std::printf("\n(checksum %zu)\n", checksum);
+    return (failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
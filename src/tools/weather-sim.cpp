@@ -0,0 +1,156 @@
+// tools/weather-sim.cpp -- Headless Monte-Carlo simulation of the weather system, for tuning the weather maps in weather.yml, and benchmarking pass_time().
+// Simulates many years of game time from many independent seeds, spread across all the worker threads, then reports how often each kind of weather happens
+// in each season. Not built by default; build it with the westgate-weather-sim target.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+
+#include "core/core.hpp"
+#include "util/task-graph.hpp"
+#include "util/thread-pool.hpp"
+#include "util/timer.hpp"
+#include "world/time/calendar.hpp"
+#include "world/time/time-weather.hpp"
+
+using namespace westgate;
+using std::string;
+using std::vector;
+using Season = TimeWeather::Season;
+using Weather = TimeWeather::Weather;
+
+namespace {
+
+// The results from simulating a single seed.
+struct SimResults {
+    unsigned long long  hours[4][9];    // How many hours were spent in each weather, by [season - 1][weather].
+    unsigned long long  blizzards;      // How many times a blizzard started.
+    unsigned long long  changes;        // How many times the weather changed.
+    unsigned long long  storms;         // How many times a storm (or blizzard) started.
+};
+
+// Simulates the specified number of years from a single seed.
+SimResults simulate(unsigned int seed, int years)
+{
+    TimeWeather time_weather(true);
+    time_weather.reset(seed);
+    time_weather.load_strings();
+
+    // The weather only ever changes on the hour, so checking it once an hour doesn't miss anything.
+    SimResults results{};
+    Weather old_weather = time_weather.weather();
+    const int hours = years * calendar::DAYS_PER_YEAR * 24;
+    for (int i = 0; i < hours; i++)
+    {
+        time_weather.pass_time(TimeWeather::HOUR);
+        const Weather weather = time_weather.weather();
+        results.hours[static_cast<int>(time_weather.current_season()) - 1][static_cast<int>(weather)]++;
+        if (weather == old_weather) continue;
+        results.changes++;
+        const bool storm = (weather == Weather::STORMY || weather == Weather::BLIZZARD), old_storm = (old_weather == Weather::STORMY || old_weather ==
+            Weather::BLIZZARD);
+        if (storm && !old_storm) results.storms++;
+        if (weather == Weather::BLIZZARD) results.blizzards++;
+        old_weather = weather;
+    }
+    return results;
+}
+
+}   // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 3)
+    {
+        std::cerr << "Usage: westgate-weather-sim [years per seed] [seeds]\n";
+        return EXIT_FAILURE;
+    }
+    int years = 100, seeds = 256;
+    try
+    {
+        if (argc > 1) years = std::stoi(argv[1]);
+        if (argc > 2) seeds = std::stoi(argv[2]);
+    }
+    catch (std::exception&) { years = seeds = 0; }
+    if (years < 1 || seeds < 1)
+    {
+        std::cerr << "Years and seeds must both be positive numbers.\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        core().init_core({"-no-colour"});
+        ThreadPool &pool = core().thread_pool();
+        std::cout << "Simulating " << years << " years from each of " << seeds << " seeds, on " << pool.threads() <<
+            (pool.threads() == 1 ? " thread" : " threads") << "...\n";
+
+        // Each seed is simulated separately, with its own TimeWeather and random number generator, so the results don't depend on how they're shared out.
+        vector<SimResults> results(seeds);
+        TaskGraph tasks;
+        for (int i = 0; i < seeds; i++)
+            tasks.add("seed " + std::to_string(i), [&results, i, years] { results.at(i) = simulate(i + 1, years); });
+        Timer timer;
+        tasks.start(pool);
+        tasks.wait_all();
+        const double seconds = std::max(timer.elapsed(), 1u) / 1000.0;
+
+        SimResults total{};
+        for (auto &result : results)
+        {
+            for (int season = 0; season < 4; season++)
+                for (int weather = 0; weather < 9; weather++)
+                    total.hours[season][weather] += result.hours[season][weather];
+            total.blizzards += result.blizzards;
+            total.changes += result.changes;
+            total.storms += result.storms;
+        }
+
+        // The steady-state distribution of the weather in each season, as a percentage of the time spent in that season.
+        TimeWeather names(true);
+        std::printf("\n%-10s", "");
+        for (int weather = 0; weather < 9; weather++)
+            std::printf("%10s", names.weather_str(static_cast<Weather>(weather)).c_str());
+        std::printf("\n");
+        for (int season = 0; season < 4; season++)
+        {
+            unsigned long long season_hours = 0;
+            for (int weather = 0; weather < 9; weather++)
+                season_hours += total.hours[season][weather];
+            std::printf("%-10s", names.season_str(static_cast<Season>(season + 1)).c_str());
+            for (int weather = 0; weather < 9; weather++)
+                std::printf("%9.2f%%", season_hours ? 100.0 * total.hours[season][weather] / season_hours : 0.0);
+            std::printf("\n");
+        }
+
+        const double total_years = static_cast<double>(years) * seeds;
+        std::printf("\nPer year: %.1f weather changes, %.1f storms, %.1f blizzards.\n", total.changes / total_years, total.storms / total_years,
+            total.blizzards / total_years);
+        std::printf("Simulated %.0f years in %.2f seconds (%.3g game seconds per second).\n", total_years, seconds, total_years * calendar::DAYS_PER_YEAR *
+            TimeWeather::DAY / seconds);
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    core().destroy_core(EXIT_SUCCESS);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+// tools/wrap-bench.cpp -- Micro-benchmark for the word-wrap code, comparing strx::wrap_lines() and ansi_vector_split() against the word-wrap code they
+// replaced. Checks that all of them wrap the text the same way first. Not built by default; build it with the westgate-wrap-bench target.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "util/strx.hpp"
+
+using namespace westgate;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+
+// A typical room description, with a paragraph break and colour tags, as Room::look() would wrap it.
+const string ROOM_DESC = "  The warped wooden floorboards creak in protest as you step into an inn that has seen better days, the scents of sweat and stale "
+    "beer hanging in the air. Sunlight filters in through dusty, cracked windows and rickety shutters, though most of the light in this dingy place comes from "
+    "tarnished hanging lanterns or candles upon the numerous heavy wooden tables, each table flanked by simple, worn benches. {nl}The heavy door - barred at "
+    "night - leads east to the streets outside, while the bar occupying the west side of the room is lit by flickering candles from an old wooden chandelier "
+    "overhead, numerous barrels and shelves stacked with bottles offering solace in these trying times. {c}There are three obvious exits: {C}east {c}(open), "
+    "{C}west {c}and {C}up{c}.";
+
+// Strips the colour tags from a string, as the old code did it.
+string legacy_ansi_strip(const string_view str)
+{
+    string result = string{str};
+    while(true)
+    {
+        size_t found_open = result.find_first_of('{');
+        size_t found_closed = result.find_first_of('}', found_open);
+        if (found_open == string::npos || found_closed == string::npos) return result;
+        result = result.substr(0, found_open) + result.substr(found_closed + 1);
+    }
+}
+
+// The word-wrap code as it was before strx::wrap_lines() replaced it, kept here for comparison.
+vector<string> legacy_vector_split(const string_view str, size_t line_length)
+{
+    string current_line, last_tag;
+    vector<string> result, words = strx::string_explode(str, " ");
+    size_t current_pos = 0;
+
+    while(words.size())
+    {
+        string word = words.at(0);
+        words.erase(words.begin());
+
+        size_t found_open = word.find_last_of('{');
+        size_t found_closed = word.find_first_of('}', found_open);
+        size_t word_len = 0;
+        bool newline_tag = false;
+        if (found_open != string::npos && found_closed != string::npos)
+        {
+            string tag_found = word.substr(found_open, found_closed - found_open + 1);
+            if (!tag_found.compare("{nl}")) newline_tag = true;
+            else last_tag = tag_found;
+            word_len = legacy_ansi_strip(word).length();
+        }
+        else word_len = word.size();
+
+        if ((current_pos && (current_pos + word_len >= line_length)) || newline_tag)
+        {
+            result.push_back(current_line);
+            current_line = (newline_tag ? "  " : "") + last_tag + word;
+            current_pos = word_len + (newline_tag ? 3 : 1);
+        }
+        else
+        {
+            current_line += (current_pos  ? " " : "") + word;
+            current_pos += word_len + 1;
+        }
+    }
+    if (current_line.size()) result.push_back(current_line);
+    return result;
+}
+
+// Runs a function over and over, and returns how many nanoseconds each run took on average.
+template<typename F> double time_runs(int runs, F func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++)
+        func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+}   // anonymous namespace
+
+// Main program entry point.
+int main(int argc, char** argv)
+{
+    const int runs = (argc > 1 ? std::stoi(argv[1]) : 20000);
+    bool all_match = true;
+    size_t checksum = 0;    // Stops the compiler from optimizing the benchmarks away.
+
+    std::printf("%-22s%8s%14s%14s%14s\n", "Input", "Width", "Old (ns)", "Split (ns)", "Engine (ns)");
+    for (int repeats : {1, 10, 50})
+    {
+        string text;
+        for (int i = 0; i < repeats; i++)
+            text += ROOM_DESC;
+        const int text_runs = std::max(1, runs / repeats / repeats);
+
+        for (size_t width : {40, 80, 120})
+        {
+            // The visible text has to match, but the tags can differ: the old code could carry the wrong colour tag onto a new line.
+            const vector<string> old_lines = legacy_vector_split(text, width), new_lines = strx::ansi_vector_split(text, width);
+            bool match = (old_lines.size() == new_lines.size());
+            for (size_t i = 0; match && i < old_lines.size(); i++)
+                if (legacy_ansi_strip(old_lines.at(i)) != strx::ansi_strip(new_lines.at(i))) match = false;
+            if (!match) all_match = false;
+
+            vector<strx::WrappedLine> lines;
+            const double old_ns = time_runs(text_runs, [&] { checksum += legacy_vector_split(text, width).size(); });
+            const double split_ns = time_runs(text_runs, [&] { checksum += strx::ansi_vector_split(text, width).size(); });
+            const double engine_ns = time_runs(text_runs, [&] { checksum += strx::wrap_lines(text, width, lines); });
+            std::printf("%-22s%8zu%14.0f%14.0f%14.0f%s\n", (std::to_string(text.size()) + " chars").c_str(), width, old_ns, split_ns, engine_ns,
+                (match ? "" : "  MISMATCH"));
+        }
+    }
+    std::printf("\n%s (checksum %zu)\n", (all_match ? "All outputs match." : "Some outputs did not match!"), checksum);
+    return (all_match ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,65 @@
+// util/alloc-count.cpp -- Counts how many times each thread allocates memory on the heap, by replacing the global operator new, so that code which is meant
+// to run without allocating anything can be checked. Debug builds only; release builds keep the standard operator new.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <new>
+
+#include "util/alloc-count.hpp"
+
+#ifdef WESTGATE_BUILD_DEBUG
+namespace {
+
+// Each thread keeps its own count, so it costs no more than an increment, and the worker threads don't muddy the count for the main thread.
+thread_local unsigned long long thread_allocations = 0;
+
+// Allocates memory with malloc(), counting the allocation. Returns nullptr on failure.
+void* counted_alloc(size_t size) noexcept
+{
+    thread_allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+}   // anonymous namespace
+
+// The replacements for the global operator new and delete. Aligned allocations are left to the standard library, which pairs them with its own delete.
+void* operator new(size_t size)
+{
+    if (void* ptr = counted_alloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size)
+{
+    if (void* ptr = counted_alloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+namespace westgate::alloc_count {
+
+// Returns how many times the calling thread has allocated memory with operator new.
+unsigned long long allocations() { return thread_allocations; }
+
+}   // namespace westgate::alloc_count
+#endif  // WESTGATE_BUILD_DEBUG
@@ -0,0 +1,29 @@
+// util/alloc-count.hpp -- Counts how many times each thread allocates memory on the heap, by replacing the global operator new, so that code which is meant
+// to run without allocating anything can be checked. Debug builds only; release builds keep the standard operator new.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+#ifdef WESTGATE_BUILD_DEBUG
+namespace westgate::alloc_count {
+
+unsigned long long  allocations();  // Returns how many times the calling thread has allocated memory with operator new.
+
+}   // namespace westgate::alloc_count
+#endif  // WESTGATE_BUILD_DEBUG
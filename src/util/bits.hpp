@@ -0,0 +1,40 @@
+// util/bits.hpp -- Small bit-twiddling helpers shared by the text scanner and the event scheduler, using the compiler's intrinsics where it has them.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace westgate::bits {
+
+// Returns the index of the lowest set bit in a non-zero integer.
+inline int lowest_bit(uint64_t bits)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+}   // namespace westgate::bits
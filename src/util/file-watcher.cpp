@@ -0,0 +1,106 @@
+// util/file-watcher.cpp -- Watches a folder for modified files, so that game data can be reloaded while the game is running. Currently only supported on
+// Linux (via inotify); on other platforms, the watcher is simply inactive.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <algorithm>
+
+#ifdef WESTGATE_TARGET_LINUX
+#include <sys/inotify.h>    // inotify_init1(), inotify_add_watch(), inotify_rm_watch()
+#include <unistd.h>         // close(), read()
+#endif
+
+#include "core/core.hpp"
+#include "util/file-watcher.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace westgate {
+
+#ifdef WESTGATE_TARGET_LINUX
+// Starts watching the specified folder.
+FileWatcher::FileWatcher(const string_view folder) : fd_(-1), wd_(-1)
+{
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0)
+    {
+        core().nonfatal("Unable to initialize inotify, file watching is disabled.", Core::CORE_WARN);
+        return;
+    }
+
+    // Editors often save by writing a temporary file and then moving it over the original, so we need to catch both of these.
+    wd_ = inotify_add_watch(fd_, string{folder}.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd_ < 0)
+    {
+        core().nonfatal("Unable to watch folder: " + string{folder}, Core::CORE_WARN);
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+    core().log("Watching for changes in " + string{folder});
+}
+
+// Stops watching the folder.
+FileWatcher::~FileWatcher()
+{
+    if (fd_ < 0) return;
+    if (wd_ >= 0) inotify_rm_watch(fd_, wd_);
+    close(fd_);
+}
+
+// Returns the names of any files that have been written to since the last check. Does not block.
+vector<string> FileWatcher::changed_files()
+{
+    vector<string> files;
+    if (fd_ < 0) return files;
+
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        const ssize_t len = read(fd_, buffer, sizeof(buffer));
+        if (len <= 0) break;    // Either nothing left to read (EAGAIN), or an error; either way, we're done for now.
+        for (ssize_t pos = 0; pos < len; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + pos);
+            if (event->len)
+            {
+                const string filename = event->name;
+                if (std::find(files.begin(), files.end(), filename) == files.end()) files.push_back(filename);
+            }
+            pos += sizeof(inotify_event) + event->len;
+        }
+    }
+    return files;
+}
+#else
+// Starts watching the specified folder.
+FileWatcher::FileWatcher(const string_view) : fd_(-1), wd_(-1)
+{ core().nonfatal("Watching for changed files is only supported on Linux.", Core::CORE_WARN); }
+
+// Stops watching the folder.
+FileWatcher::~FileWatcher() { }
+
+// Returns the names of any files that have been written to since the last check. Does not block.
+vector<string> FileWatcher::changed_files() { return {}; }
+#endif
+
+// Checks if the watcher is actually running.
+bool FileWatcher::active() const { return fd_ >= 0; }
+
+}   // namespace westgate
@@ -0,0 +1,37 @@
+// util/file-watcher.hpp -- Watches a folder for modified files, so that game data can be reloaded while the game is running. Currently only supported on
+// Linux (via inotify); on other platforms, the watcher is simply inactive.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+namespace westgate {
+
+class FileWatcher {
+public:
+                FileWatcher(const std::string_view folder); // Starts watching the specified folder.
+                ~FileWatcher();     // Stops watching the folder.
+    bool        active() const;     // Checks if the watcher is actually running.
+    std::vector<std::string>    changed_files();    // Returns the names of any files that have been written to since the last check. Does not block.
+
+private:
+    int fd_;    // The inotify file descriptor, or -1 if inactive.
+    int wd_;    // The inotify watch descriptor, or -1 if inactive.
+};
+
+}   // namespace westgate
@@ -0,0 +1,102 @@
+// util/format.cpp -- Builds short messages from a pattern and a list of values, in a buffer on the stack, so that putting together a line of text doesn't need
+// a chain of temporary strings glued together with +.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <charconv>
+#include <cstring>
+
+#include "util/format.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+
+namespace westgate {
+
+// Allows the message to be used anywhere a string_view is.
+Format::operator string_view() const { return view(); }
+
+// Adds text to the end of the message, moving it to the heap if it no longer fits on the stack.
+void Format::append(const char* text, size_t length)
+{
+    if (!on_heap_ && size_ + length <= STACK_SIZE)
+    {
+        std::memcpy(stack_ + size_, text, length);
+        size_ += length;
+        return;
+    }
+    if (!on_heap_)
+    {
+        heap_.reserve((size_ + length) * 2);
+        heap_.assign(stack_, size_);
+        on_heap_ = true;
+    }
+    heap_.append(text, length);
+}
+
+// Fills in the placeholders in the pattern.
+void Format::build(const string_view pattern, const Arg* args, size_t arg_count)
+{
+    size_t arg_pos = 0, text_start = 0;
+    while (true)
+    {
+        const size_t percent = pattern.find('%', text_start);
+        if (percent == string_view::npos) break;
+        append(pattern.data() + text_start, percent - text_start);
+        if (percent + 1 >= pattern.size()) throw runtime_error("Format string ends with a lone % sign: " + string{pattern});
+        const char placeholder = pattern[percent + 1];
+        text_start = percent + 2;
+        if (placeholder == '%')
+        {
+            append("%", 1);
+            continue;
+        }
+        if (placeholder != 's' && placeholder != 'd')
+            throw runtime_error("Unknown placeholder %" + string(1, placeholder) + " in format string: " + string{pattern});
+        if (arg_pos >= arg_count) throw runtime_error("Too few values given for format string: " + string{pattern});
+
+        const Arg &arg = args[arg_pos++];
+        if (placeholder == 's')
+        {
+            if (arg.type != Arg::Type::TEXT) throw runtime_error("Number given for %s placeholder in format string: " + string{pattern});
+            append(arg.text.data(), arg.text.size());
+            continue;
+        }
+        if (arg.type == Arg::Type::TEXT) throw runtime_error("Text given for %d placeholder in format string: " + string{pattern});
+        char digits[24];
+        const std::to_chars_result result = (arg.type == Arg::Type::SIGNED ? std::to_chars(digits, digits + sizeof(digits), arg.signed_value) :
+            std::to_chars(digits, digits + sizeof(digits), arg.unsigned_value));
+        append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+    append(pattern.data() + text_start, pattern.size() - text_start);
+    if (arg_pos < arg_count) throw runtime_error("Too many values given for format string: " + string{pattern});
+}
+
+// Returns a pointer to the message. It is not null-terminated.
+const char* Format::data() const { return (on_heap_ ? heap_.data() : stack_); }
+
+// Returns the length of the message, in bytes.
+size_t Format::size() const { return (on_heap_ ? heap_.size() : size_); }
+
+// Copies the message into a string.
+string Format::str() const { return string{view()}; }
+
+// Returns the message.
+string_view Format::view() const { return {data(), size()}; }
+
+}   // namespace westgate
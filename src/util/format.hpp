@@ -0,0 +1,79 @@
+// util/format.hpp -- Builds short messages from a pattern and a list of values, in a buffer on the stack, so that putting together a line of text doesn't need
+// a chain of temporary strings glued together with +.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+#include <type_traits>
+
+namespace westgate {
+
+// Placeholders in the pattern are %s for text (strings, string_views, C strings or single chars), %d for integers, and %% for a percent sign. Curly braces are
+// left alone, so colour tags like {G} can be used as normal. The values are checked against the placeholders, and a mismatch throws a runtime_error.
+class Format
+{
+public:
+    static constexpr size_t STACK_SIZE = 256;   // Messages up to this many bytes are built without allocating any memory.
+
+                        // Builds a message from a pattern, filling in each placeholder with the next value.
+    template<typename... Args> Format(std::string_view pattern, const Args&... args)
+    {
+        const Arg packed[] = { Arg{args}..., Arg{} };   // The extra empty Arg means the array is never zero-length.
+        build(pattern, packed, sizeof...(Args));
+    }
+                        Format(const Format&) = delete;
+    Format&             operator=(const Format&) = delete;
+                        operator std::string_view() const;  // Allows the message to be used anywhere a string_view is.
+    const char*         data() const;   // Returns a pointer to the message. It is not null-terminated.
+    size_t              size() const;   // Returns the length of the message, in bytes.
+    std::string         str() const;    // Copies the message into a string.
+    std::string_view    view() const;   // Returns the message.
+
+private:
+    // One of the values to fill in a placeholder.
+    struct Arg {
+        enum class Type : uint8_t { NONE, TEXT, SIGNED, UNSIGNED };
+
+        Type                type = Type::NONE;  // What kind of value this is.
+        std::string_view    text;               // The text, for a TEXT value.
+        long long           signed_value = 0;   // The number, for a SIGNED value.
+        unsigned long long  unsigned_value = 0; // The number, for an UNSIGNED value.
+
+        Arg() = default;
+        Arg(const char &ch) : type(Type::TEXT), text(&ch, 1) { }
+        Arg(const char* str) : type(Type::TEXT), text(str) { }
+        Arg(const std::string &str) : type(Type::TEXT), text(str) { }
+        Arg(std::string_view str) : type(Type::TEXT), text(str) { }
+        template<typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>, int> = 0> Arg(T value)
+        {
+            if constexpr (std::is_signed_v<T>) { type = Type::SIGNED; signed_value = value; }
+            else { type = Type::UNSIGNED; unsigned_value = value; }
+        }
+    };
+
+    void    append(const char* text, size_t length);    // Adds text to the end of the message, moving it to the heap if it no longer fits on the stack.
+    void    build(std::string_view pattern, const Arg* args, size_t arg_count); // Fills in the placeholders in the pattern.
+
+    std::string heap_;              // The message, if it grew too long for the stack buffer.
+    bool        on_heap_ = false;   // Whether the message has been moved into heap_.
+    size_t      size_ = 0;          // The length of the message in the stack buffer.
+    char        stack_[STACK_SIZE]; // The message, while it fits.
+};
+
+}   // namespace westgate
@@ -23,6 +23,7 @@
 #include "util/filex.hpp"
 #include "util/namegen.hpp"
 #include "util/random.hpp"
+#include "util/static-data.hpp"
 #include "util/strx.hpp"
 #include "util/yaml.hpp"
 #include "world/entity/entity.hpp"
@@ -34,21 +35,97 @@ using std::string_view;
 
 namespace westgate {
 
+// Adds a string to the end of the list.
+void NameList::add(const string_view str)
+{
+    if (offsets_.empty()) offsets_.push_back(0);
+    buffer_.append(str);
+    offsets_.push_back(buffer_.size());
+}
+
+// Replaces the contents of the list with already-packed data. The offsets array must contain count + 1 entries, the last being the end of the data.
+void NameList::assign(const string_view data, const uint32_t* offsets, size_t count)
+{
+    if (offsets[count] != data.size()) throw runtime_error("Invalid packed name list data!");
+    buffer_ = data;
+    offsets_.assign(offsets, offsets + count + 1);
+}
+
+// Replaces the contents of the list with the contents of a vector.
+void NameList::assign(const std::vector<string> &vec)
+{
+    size_t total_size = 0;
+    for (auto &str : vec)
+        total_size += str.size();
+    buffer_.clear();
+    buffer_.reserve(total_size);
+    offsets_.clear();
+    offsets_.reserve(vec.size() + 1);
+    for (auto &str : vec)
+        add(str);
+}
+
+// Retrieves a string from the list.
+string_view NameList::get(size_t index) const
+{
+    if (index >= size()) throw std::out_of_range("Invalid name list index: " + std::to_string(index));
+    return string_view(buffer_).substr(offsets_[index], offsets_[index + 1] - offsets_[index]);
+}
+
+// Picks a random string from the list.
+string NameList::random(RandomStream &rng) const
+{
+    if (!size()) throw runtime_error("Attempt to pick from an empty name list!");
+    return string{get(rng.get<size_t>(0, size() - 1))};
+}
+
+// Returns the number of strings in the list.
+size_t NameList::size() const { return (offsets_.empty() ? 0 : offsets_.size() - 1); }
+
 // Picks a consonant from the table, for forming atoms.
 string ProcNameGen::consonant()
 {
-    const size_t pos = rnd::get<size_t>(0, consonant_block.size() - 1);
+    const size_t pos = rng_.get<size_t>(0, consonant_block.size() - 1);
     return consonant_block.substr(pos, 1);
 }
 
-// Loads the namelists from the data files.
+// Loads the namelists from the data files. Use prefetch() rather than calling this directly.
 void ProcNameGen::load_namelists()
 {
+#ifdef WESTGATE_STATIC_GAMEDATA
+    // If the data files haven't been modified since the build, we can just use the copies compiled into the binary.
+    auto static_list = [](const string_view filename, hash_wg hash, const static_data::StringList &list, NameList &names) {
+        if (!static_data::file_matches(core().datafile(filename), hash)) return false;
+        names.assign(list.data, list.offsets, list.size);
+        return true;
+    };
+    bool all_static = static_list("namegen/names-f.txt", static_data::names_f_txt_hash, static_data::names_f, names_f);
+    all_static &= static_list("namegen/names-m.txt", static_data::names_m_txt_hash, static_data::names_m, names_m);
+    all_static &= static_list("namegen/surname-a.txt", static_data::surname_a_txt_hash, static_data::surname_a, names_s_a);
+    all_static &= static_list("namegen/surname-b.txt", static_data::surname_b_txt_hash, static_data::surname_b, names_s_b);
+    if (all_static && static_data::file_matches(core().datafile("namegen/namegen-strings.yml"), static_data::namegen_strings_yml_hash))
+    {
+        consonant_block = static_data::namegen_consonant_block;
+        vowel_block = static_data::namegen_vowel_block;
+        v4_template = static_data::namegen_v4_template;
+        auto pv3_list = [](const static_data::StringList &list, NameList &names) { names.assign(list.data, list.offsets, list.size); };
+        pv3_list(static_data::namegen_pv3_c, pv3_c);
+        pv3_list(static_data::namegen_pv3_d, pv3_d);
+        pv3_list(static_data::namegen_pv3_e, pv3_e);
+        pv3_list(static_data::namegen_pv3_f, pv3_f);
+        pv3_list(static_data::namegen_pv3_i, pv3_i);
+        pv3_list(static_data::namegen_pv3_k, pv3_k);
+        pv3_list(static_data::namegen_pv3_v, pv3_v);
+        pv3_list(static_data::namegen_pv3_x, pv3_x);
+        return;
+    }
+    core().log("Namegen data files have been modified, loading them from disk.");
+#endif
     const unsigned int ftv_flags = filex::FTV_FLAG_IGNORE_BLANK_LINES | filex::FTV_FLAG_IGNORE_COMMENTS;
-    names_f = filex::file_to_vec(core().datafile("namegen/names-f.txt"), ftv_flags);
-    names_m = filex::file_to_vec(core().datafile("namegen/names-m.txt"), ftv_flags);
-    names_s_a = filex::file_to_vec(core().datafile("namegen/surname-a.txt"), ftv_flags);
-    names_s_b = filex::file_to_vec(core().datafile("namegen/surname-b.txt"), ftv_flags);
+    names_f.assign(filex::file_to_vec(core().datafile("namegen/names-f.txt"), ftv_flags));
+    names_m.assign(filex::file_to_vec(core().datafile("namegen/names-m.txt"), ftv_flags));
+    names_s_a.assign(filex::file_to_vec(core().datafile("namegen/surname-a.txt"), ftv_flags));
+    names_s_b.assign(filex::file_to_vec(core().datafile("namegen/surname-b.txt"), ftv_flags));
 
     YAML yaml(core().datafile("namegen/namegen-strings.yml"));
     if (!yaml.is_map()) throw runtime_error("namegen-strings.yml: Invalid file format");
@@ -58,21 +135,21 @@ void ProcNameGen::load_namelists()
     vowel_block = strx::decode_compressed_string(yaml.val("vowel_block"));
     if (!yaml.key_exists("v4_template")) throw runtime_error("namegen-strings.yml: v4_template missing");
     v4_template = yaml.val("v4_template");
-    pv3_c = yaml.get_seq("pv3_c");
-    pv3_d = yaml.get_seq("pv3_d");
-    pv3_e = yaml.get_seq("pv3_e");
-    pv3_f = yaml.get_seq("pv3_f");
-    pv3_i = yaml.get_seq("pv3_i");
-    pv3_k = yaml.get_seq("pv3_k");
-    pv3_v = yaml.get_seq("pv3_v");
-    pv3_x = yaml.get_seq("pv3_x");
+    pv3_c.assign(yaml.get_seq("pv3_c"));
+    pv3_d.assign(yaml.get_seq("pv3_d"));
+    pv3_e.assign(yaml.get_seq("pv3_e"));
+    pv3_f.assign(yaml.get_seq("pv3_f"));
+    pv3_i.assign(yaml.get_seq("pv3_i"));
+    pv3_k.assign(yaml.get_seq("pv3_k"));
+    pv3_v.assign(yaml.get_seq("pv3_v"));
+    pv3_x.assign(yaml.get_seq("pv3_x"));
 }
 
 // Returns a random feminine name.
-string ProcNameGen::name_f() { return names_f[rnd::get<unsigned int>(0, names_f.size() - 1)]; }
+string ProcNameGen::name_f() { return names_f.random(rng_); }
 
 // Returns a random masculine name.
-string ProcNameGen::name_m() { return names_m[rnd::get<unsigned int>(0, names_m.size() - 1)]; }
+string ProcNameGen::name_m() { return names_m.random(rng_); }
 
 // Generates a random name (v1 code, Elite-style).
 string ProcNameGen::namegen_v1()
@@ -83,7 +160,7 @@ string ProcNameGen::namegen_v1()
     for (int i = 0; i < 4; i++)
     {
         // The type of atom chosen depends on the seed.
-        const int choice = rnd::get(1, 10);
+        const int choice = rng_.get(1, 10);
 
         // Assign the appropriate type of atom.
         if (choice >= 1 && choice <= 3) atom = vowel() + consonant();
@@ -96,7 +173,7 @@ string ProcNameGen::namegen_v1()
     }
 
     // Trim the name's length down to a specified number.
-    const int length = rnd::get(4, 8);
+    const int length = rng_.get(4, 8);
     name = name.substr(0, length);
 
     // Make the first letter of the name capitalized.
@@ -120,10 +197,11 @@ string ProcNameGen::namegen_v4(const string_view pattern, unsigned int max_len,
 // Generates a random NPC name, using a combination of the other systems.
 string ProcNameGen::npc_name(Gender gender, bool with_surname)
 {
+    prefetch();
     const string surname_str = (with_surname ? " " + surname() : "");
 
     // 1 in 10 chance of using a pre-existing name list.
-    if (rnd::get<bool>(0.1f) && (gender == Gender::HE || gender == Gender::SHE))
+    if (rng_.get<bool>(0.1f) && (gender == Gender::HE || gender == Gender::SHE))
     {
         switch(gender)
         {
@@ -160,8 +238,8 @@ string ProcNameGen::npc_name(Gender gender, bool with_surname)
         else
         {
             // The v1 and v3 name generators tend to be a bit clunky-sounding, so they're better used for masculine/neutral names
-            if (rnd::get<bool>(0.2f)) chosen_name = namegen_v1();
-            else if (rnd::get<bool>(0.2f)) chosen_name = random_word(true);
+            if (rng_.get<bool>(0.2f)) chosen_name = namegen_v1();
+            else if (rng_.get<bool>(0.2f)) chosen_name = random_word(true);
             else chosen_name = namegen_v4(v4_template, 8, 4);
         }
 
@@ -184,44 +262,47 @@ string ProcNameGen::npc_name(Gender gender, bool with_surname)
     }
 }
 
+// Loads the namelists now, if they haven't been loaded already. Safe to call from a worker thread.
+void ProcNameGen::prefetch() { std::call_once(loaded, &ProcNameGen::load_namelists, this); }
+
 // Ends of words.
 string ProcNameGen::pv3_t()
 {
-    if (rnd::get<bool>()) return pv3_v[rnd::get<int>(0, pv3_v.size() - 1)] + pv3_f[rnd::get<int>(0, pv3_f.size() - 1)];
-    else return pv3_v[rnd::get<int>(0, pv3_v.size() - 1)] + pv3_e[rnd::get<int>(0, pv3_e.size() - 1)] + "e";
+    if (rng_.get<bool>()) return pv3_v.random(rng_) + pv3_f.random(rng_);
+    else return pv3_v.random(rng_) + pv3_e.random(rng_) + "e";
 }
 
 // Generates a random word.
 string ProcNameGen::random_word(bool cap)
 {
     string gen_name;
-    switch(rnd::get(1, 8))
+    switch(rng_.get(1, 8))
     {
-        case 1: case 2: gen_name = pv3_c[rnd::get<int>(0, pv3_c.size() - 1)] + pv3_t(); break;
-        case 3: gen_name = pv3_c[rnd::get<int>(0, pv3_c.size() - 1)] + pv3_x[rnd::get<int>(0, pv3_x.size() - 1)]; break;
-        case 4: gen_name = pv3_c[rnd::get<int>(0, pv3_c.size() - 1)] + pv3_d[rnd::get<int>(0, pv3_d.size() - 1)] +
-            pv3_f[rnd::get<int>(0, pv3_f.size() - 1)]; break;
-        case 5: gen_name = pv3_c[rnd::get<int>(0, pv3_c.size() - 1)] + pv3_v[rnd::get<int>(0, pv3_v.size() - 1)] +
-            pv3_f[rnd::get<int>(0, pv3_f.size() - 1)] + pv3_t(); break;
-        case 6: gen_name = pv3_i[rnd::get<int>(0, pv3_i.size() - 1)] + pv3_t(); break;
-        case 7: gen_name = pv3_i[rnd::get<int>(0, pv3_i.size() - 1)] + pv3_c[rnd::get<int>(0, pv3_c.size() - 1)] + pv3_t(); break;
-        case 8: gen_name = pv3_k[rnd::get<int>(0, pv3_k.size() - 1)] + pv3_v[rnd::get<int>(0, pv3_v.size() - 1)] +
-            pv3_k[rnd::get<int>(0, pv3_k.size() - 1)] + pv3_v[rnd::get<int>(0, pv3_v.size() - 1)]; break;
+        case 1: case 2: gen_name = pv3_c.random(rng_) + pv3_t(); break;
+        case 3: gen_name = pv3_c.random(rng_) + pv3_x.random(rng_); break;
+        case 4: gen_name = pv3_c.random(rng_) + pv3_d.random(rng_) + pv3_f.random(rng_); break;
+        case 5: gen_name = pv3_c.random(rng_) + pv3_v.random(rng_) + pv3_f.random(rng_) + pv3_t(); break;
+        case 6: gen_name = pv3_i.random(rng_) + pv3_t(); break;
+        case 7: gen_name = pv3_i.random(rng_) + pv3_c.random(rng_) + pv3_t(); break;
+        case 8: gen_name = pv3_k.random(rng_) + pv3_v.random(rng_) + pv3_k.random(rng_) + pv3_v.random(rng_); break;
     }
     if (cap) gen_name[0] = std::toupper(gen_name[0]);
     return gen_name;
 }
 
+// Returns the name generator's stream of random numbers.
+RandomStream& ProcNameGen::rng() { return rng_; }
+
 // Generates a random surname.
 string ProcNameGen::surname()
 {
-    string part_a = names_s_a[rnd::get<int>(0, names_s_a.size() - 1)], part_b;
+    string part_a = names_s_a.random(rng_), part_b;
     do
     {
-        part_b = names_s_b[rnd::get<int>(0, names_s_b.size() - 1)];
+        part_b = names_s_b.random(rng_);
     } while (part_a == part_b || part_a[part_a.size() - 1] == part_b[0]);
     part_a[0] = std::toupper(part_a[0]);
-    if (rnd::get<bool>(0.333f))
+    if (rng_.get<bool>(0.333f))
     {
         part_b[0] = std::toupper(part_b[0]);
         return part_a + "-" + part_b;
@@ -232,7 +313,7 @@ string ProcNameGen::surname()
 // Picks a vowel from the table, for forming atoms.
 string ProcNameGen::vowel()
 {
-    const size_t pos = rnd::get<size_t>(0, vowel_block.size() - 1);
+    const size_t pos = rng_.get<size_t>(0, vowel_block.size() - 1);
     return vowel_block.substr(pos, 1);
 }
 
@@ -19,17 +19,40 @@
 #pragma once
 #include "core/pch.hpp" // Precompiled header
 
+#include <cstdint>
+#include <mutex>
+
+#include "util/random.hpp"
+
 namespace westgate {
 
 enum class Gender : unsigned char;  // defined in world/entity/entity.hpp
 
+// A list of strings packed into a single contiguous buffer, rather than thousands of separate heap-allocated strings.
+class NameList {
+public:
+    void        add(const std::string_view str);    // Adds a string to the end of the list.
+                // Replaces the contents of the list with already-packed data. The offsets array has count + 1 entries, the last marking the end of the data.
+    void        assign(const std::string_view data, const uint32_t* offsets, size_t count);
+    void        assign(const std::vector<std::string> &vec);    // Replaces the contents of the list with the contents of a vector.
+    std::string_view    get(size_t index) const;    // Retrieves a string from the list.
+    std::string random(RandomStream &rng) const;    // Picks a random string from the list.
+    size_t      size() const;   // Returns the number of strings in the list.
+
+private:
+    std::string             buffer_;    // All the strings in the list, back to back.
+    std::vector<uint32_t>   offsets_;   // Where each string starts in the buffer, plus an extra entry marking the end of the last string.
+};
+
 class ProcNameGen {
 public:
-    void        load_namelists();   // Loads the namelists from the data files.
     std::string npc_name(Gender gender, bool with_surname = true);  // Generates a random NPC name, using a combination of the other systems.
+    void        prefetch(); // Loads the namelists now, if they haven't been loaded already. Safe to call from a worker thread.
+    RandomStream&   rng();  // Returns the name generator's stream of random numbers.
 
 private:
     std::string consonant();    // Picks a consonant from the table, for forming atoms.
+    void        load_namelists();   // Loads the namelists from the data files. Use prefetch() rather than calling this directly.
     std::string name_f();       // Returns a random feminine name.
     std::string name_m();       // Returns a random masculine name.
     std::string namegen_v1();   // Generates a random name (v1 code, Elite-style).
@@ -39,21 +62,23 @@ private:
     std::string surname();      // Generates a random surname.
     std::string vowel();        // Picks a vowel from the table, for forming atoms.
 
-    std::string                 consonant_block;    // The consonant letter block, for v1 naming.
-    std::vector<std::string>    names_f;            // Hard-coded names list of feminine first-names.
-    std::vector<std::string>    names_m;            // Hard-coded names list of masculine first-names.
-    std::vector<std::string>    names_s_a;          // Hard-coded names list, containing the first half of surnames.
-    std::vector<std::string>    names_s_b;          // Hard-coded names list, containing the second half of surnames.
-    std::vector<std::string>    pv3_c;              // Consonant letter block, for v3 naming.
-    std::vector<std::string>    pv3_d;              // Dipthong letter block, for v3 naming.
-    std::vector<std::string>    pv3_e;              // Before silent E letter block, for v3 naming.
-    std::vector<std::string>    pv3_f;              // Final letters block, for v3 naming.
-    std::vector<std::string>    pv3_i;              // Prefix letter block, for v3 naming.
-    std::vector<std::string>    pv3_k;              // Latinate letter block, for v3 naming.
-    std::vector<std::string>    pv3_v;              // Simple vowels block, for v3 naming.
-    std::vector<std::string>    pv3_x;              // Final vowels block, for v3 naming.
-    std::string                 v4_template;        // Template used for v4 namegen.
-    std::string                 vowel_block;        // The vowel letter block, for v1 naming.
+    std::string     consonant_block;    // The consonant letter block, for v1 naming.
+    std::once_flag  loaded;             // Ensures the namelists are only loaded once, the first time they're needed.
+    NameList        names_f;            // Hard-coded names list of feminine first-names.
+    NameList        names_m;            // Hard-coded names list of masculine first-names.
+    NameList        names_s_a;          // Hard-coded names list, containing the first half of surnames.
+    NameList        names_s_b;          // Hard-coded names list, containing the second half of surnames.
+    NameList        pv3_c;              // Consonant letter block, for v3 naming.
+    NameList        pv3_d;              // Dipthong letter block, for v3 naming.
+    NameList        pv3_e;              // Before silent E letter block, for v3 naming.
+    NameList        pv3_f;              // Final letters block, for v3 naming.
+    NameList        pv3_i;              // Prefix letter block, for v3 naming.
+    NameList        pv3_k;              // Latinate letter block, for v3 naming.
+    NameList        pv3_v;              // Simple vowels block, for v3 naming.
+    NameList        pv3_x;              // Final vowels block, for v3 naming.
+    RandomStream    rng_;               // The name generator's own stream of random numbers, seeded from the world seed.
+    std::string     v4_template;        // Template used for v4 namegen.
+    std::string     vowel_block;        // The vowel letter block, for v1 naming.
 };
 
 }   // namespace westgate
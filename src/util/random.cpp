@@ -0,0 +1,92 @@
+// util/random.cpp -- Simple interface code to use effolkronium's random number generator, and the seeded random number streams used by the game world.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+
+#include "util/filex.hpp"
+#include "util/random.hpp"
+
+namespace westgate {
+
+namespace {
+
+// The SplitMix64 mixing function, which scrambles a 64-bit number so that similar inputs give wildly different outputs.
+uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}   // anonymous namespace
+
+// Creates a generator, seeded with the specified value.
+Xoshiro256::Xoshiro256(result_type value) { seed(value); }
+
+// Advances the generator, throwing away the specified number of results.
+void Xoshiro256::discard(unsigned long long z)
+{
+    while (z--) (*this)();
+}
+
+// Reseeds the generator with the specified value.
+void Xoshiro256::seed(result_type value)
+{
+    // The seed is expanded with SplitMix64, as recommended by the authors, which can never result in a state of all zeroes.
+    for (auto &word : state_)
+    {
+        word = splitmix64(value);
+        value += 0x9E3779B97F4A7C15ULL;
+    }
+}
+
+// Sets the generator's internal state, as returned by state().
+void Xoshiro256::set_state(const std::array<uint64_t, 4> &state) { state_ = state; }
+
+// Returns the generator's internal state.
+const std::array<uint64_t, 4>& Xoshiro256::state() const { return state_; }
+
+// Loads the stream's state from a save file.
+void RandomStream::load_data(FileReader* file)
+{
+    if (const unsigned int save_ver = file->read_data<unsigned int>();
+        save_ver != RANDOM_STREAM_SAVE_VERSION) FileReader::standard_error("Incompatible random stream data version", save_ver, RANDOM_STREAM_SAVE_VERSION);
+    std::array<uint64_t, 4> state;
+    for (auto &word : state)
+        word = file->read_data<uint64_t>();
+    if (!(state[0] | state[1] | state[2] | state[3])) FileReader::standard_error("Invalid random stream state");
+    engine().set_state(state);
+}
+
+// Saves the stream's state to a save file.
+void RandomStream::save_data(FileWriter* file) const
+{
+    file->write_data<unsigned int>(RANDOM_STREAM_SAVE_VERSION);
+    const Xoshiro256 engine = get_engine(); // The engine can only be copied out of a const stream.
+    for (auto word : engine.state())
+        file->write_data<uint64_t>(word);
+}
+
+// Seeds one of the world's streams, derived from the world seed.
+void RandomStream::seed_stream(uint64_t world_seed, Stream stream, uint32_t index)
+{
+    // The stream and index are scrambled before being mixed with the world seed, so that neighbouring streams don't start from related states.
+    seed(world_seed ^ splitmix64((static_cast<uint64_t>(stream) << 32) + index));
+}
+
+}   // namespace westgate
@@ -1,4 +1,4 @@
-// util/random.hpp -- Simple interface code to use effolkronium's random number generator.
+// util/random.hpp -- Simple interface code to use effolkronium's random number generator, and the seeded random number streams used by the game world.
 
 /*
  * SPDX-FileType: SOURCE
@@ -18,10 +18,86 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 #include "3rdparty/random/random.hpp"
 
 namespace westgate {
 
-using rnd = effolkronium::random_static;
+class FileReader;   // defined in util/filex.hpp
+class FileWriter;   // defined in util/filex.hpp
+
+using rnd = effolkronium::random_thread_local;    // Each thread has its own generator, so worker threads can safely use it too.
+
+// The xoshiro256** generator, by David Blackman and Sebastiano Vigna. It's much smaller and faster than a Mersenne Twister, and its state is small enough to
+// save along with whatever uses it.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type    default_seed = 0;   // The seed used if none is specified.
+
+                    Xoshiro256(result_type value = default_seed);   // Creates a generator, seeded with the specified value.
+                    // Creates a generator, seeded from a seed sequence such as std::seed_seq.
+                    template<typename Sseq, typename = std::enable_if_t<!std::is_arithmetic_v<Sseq> && !std::is_same_v<std::decay_t<Sseq>, Xoshiro256>>>
+                    explicit Xoshiro256(Sseq &seq) { seed(seq); }
+    void            discard(unsigned long long z);  // Advances the generator, throwing away the specified number of results.
+    static constexpr result_type    max() { return UINT64_MAX; }    // The largest number the generator can return.
+    static constexpr result_type    min() { return 0; }             // The smallest number the generator can return.
+    result_type     operator()();           // Returns the next number from the generator.
+    void            seed(result_type value);    // Reseeds the generator with the specified value.
+                    // Reseeds the generator from a seed sequence such as std::seed_seq.
+                    template<typename Sseq> void seed(Sseq &seq);
+    void            set_state(const std::array<uint64_t, 4> &state);    // Sets the generator's internal state, as returned by state().
+    const std::array<uint64_t, 4>&  state() const;  // Returns the generator's internal state.
+
+private:
+    std::array<uint64_t, 4> state_; // The generator's internal state.
+};
+
+// Seeds the generator with a fixed value, rather than std::random_device, as RandomStreams are always seeded explicitly afterwards anyway.
+struct FixedSeeder {
+    Xoshiro256::result_type operator()() const { return Xoshiro256::default_seed; }
+};
+
+// A seeded stream of random numbers, with the same interface as rnd, but its own independent state which can be saved and loaded. Each subsystem which uses
+// random numbers in the game world has its own stream, so the same world seed always plays out the same way, no matter what order things happen in.
+class RandomStream : public effolkronium::basic_random_local<Xoshiro256, FixedSeeder> {
+public:
+    // The different streams which can be seeded from the world seed. Each Region has a stream of its own, which is REGION plus the Region's ID.
+    enum class Stream : uint32_t { WEATHER, WIND, NAMEGEN, REGION };
+
+    void    load_data(FileReader* file);        // Loads the stream's state from a save file.
+    void    save_data(FileWriter* file) const;  // Saves the stream's state to a save file.
+    void    seed_stream(uint64_t world_seed, Stream stream, uint32_t index = 0);    // Seeds one of the world's streams, derived from the world seed.
+
+private:
+    static constexpr unsigned int   RANDOM_STREAM_SAVE_VERSION =    1;  // The version of the random stream data in saved game files.
+};
+
+// Returns the next number from the generator. This is called for every single random number, so it's defined here where the compiler can inline it.
+inline Xoshiro256::result_type Xoshiro256::operator()()
+{
+    const auto rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+    const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+}
+
+// Reseeds the generator from a seed sequence such as std::seed_seq.
+template<typename Sseq> void Xoshiro256::seed(Sseq &seq)
+{
+    std::array<uint32_t, 8> words;
+    seq.generate(words.begin(), words.end());
+    for (int i = 0; i < 4; i++)
+        state_[i] = (static_cast<uint64_t>(words[i * 2]) << 32) | words[i * 2 + 1];
+    if (!(state_[0] | state_[1] | state_[2] | state_[3])) seed(default_seed);   // The state can never be all zeroes.
+}
 
 }   // namespace westgate
@@ -0,0 +1,306 @@
+// util/scan.cpp -- Vectorized scanning for small sets of delimiter bytes, such as the brackets and spaces used by colour tags and conditional tags, and for
+// bytes which aren't plain ASCII.
+// SSE2 and AVX2 versions are used where the CPU supports them, chosen when the game starts, with a plain C++ version for everything else.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <cstring>
+
+#include "util/scan.hpp"
+
+// SSE2 is part of the x86-64 baseline, so it's always there; AVX2 has to be checked for at runtime.
+#if defined(__x86_64__) || defined(_M_X64)
+#define WESTGATE_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define WESTGATE_TARGET_AVX2
+#else
+#define WESTGATE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using std::runtime_error;
+using std::string_view;
+
+namespace westgate::scan {
+
+namespace {
+
+// Scans a block one byte at a time, starting partway through if needed. Used on its own when nothing faster is available, and for the leftover bytes at the end
+// of a block otherwise.
+uint64_t scan_scalar(const char* data, size_t start, size_t length, const ByteSet &set)
+{
+    uint64_t mask = 0;
+    for (size_t i = start; i < length; i++)
+        if (set.contains(data[i])) mask |= 1ULL << i;
+    return mask;
+}
+
+// As scan_scalar(), but for bytes which aren't plain ASCII.
+uint64_t scan_non_ascii_scalar(const char* data, size_t start, size_t length)
+{
+    uint64_t mask = 0;
+    for (size_t i = start; i < length; i++)
+        if (static_cast<unsigned char>(data[i]) >= 0x80) mask |= 1ULL << i;
+    return mask;
+}
+
+#ifdef WESTGATE_SCAN_X86
+// Scans a block sixteen bytes at a time, with SSE2.
+uint64_t scan_sse2(const char* data, size_t length, const ByteSet &set)
+{
+    __m128i needles[MAX_BYTES];
+    for (size_t i = 0; i < set.size(); i++)
+        needles[i] = _mm_set1_epi8(set.byte(i));
+
+    uint64_t mask = 0;
+    size_t pos = 0;
+    for (; pos + 16 <= length; pos += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i hits = _mm_setzero_si128();
+        for (size_t i = 0; i < set.size(); i++)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(hits))) << pos;
+    }
+    return mask | scan_scalar(data, pos, length, set);
+}
+
+// Scans a block thirty-two bytes at a time, with AVX2.
+WESTGATE_TARGET_AVX2 uint64_t scan_avx2(const char* data, size_t length, const ByteSet &set)
+{
+    __m256i needles[MAX_BYTES];
+    for (size_t i = 0; i < set.size(); i++)
+        needles[i] = _mm256_set1_epi8(set.byte(i));
+
+    uint64_t mask = 0;
+    size_t pos = 0;
+    for (; pos + 32 <= length; pos += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i hits = _mm256_setzero_si256();
+        for (size_t i = 0; i < set.size(); i++)
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needles[i]));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hits))) << pos;
+    }
+    return mask | scan_scalar(data, pos, length, set);
+}
+
+// Scans a block sixteen bytes at a time for bytes which aren't plain ASCII, with SSE2. The high bit of each byte is all that's needed, and SSE2 can gather
+// those up in a single instruction.
+uint64_t scan_non_ascii_sse2(const char* data, size_t length)
+{
+    uint64_t mask = 0;
+    size_t pos = 0;
+    for (; pos + 16 <= length; pos += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(chunk))) << pos;
+    }
+    return mask | scan_non_ascii_scalar(data, pos, length);
+}
+
+// Scans a block thirty-two bytes at a time for bytes which aren't plain ASCII, with AVX2.
+WESTGATE_TARGET_AVX2 uint64_t scan_non_ascii_avx2(const char* data, size_t length)
+{
+    uint64_t mask = 0;
+    size_t pos = 0;
+    for (; pos + 32 <= length; pos += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(chunk))) << pos;
+    }
+    return mask | scan_non_ascii_scalar(data, pos, length);
+}
+
+// Checks if the CPU and operating system both support AVX2.
+bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    __cpuidex(info, 7, 0);
+    return os_saves_avx && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif  // WESTGATE_SCAN_X86
+
+}   // anonymous namespace
+
+// Creates a set of up to MAX_BYTES bytes.
+ByteSet::ByteSet(string_view bytes) : bytes_{}, count_(0), table_{}
+{
+    if (bytes.size() > MAX_BYTES) throw runtime_error("Too many bytes for a ByteSet: " + std::string{bytes});
+    for (const char ch : bytes)
+    {
+        if (table_[static_cast<unsigned char>(ch)]) continue;
+        table_[static_cast<unsigned char>(ch)] = true;
+        bytes_[count_++] = ch;
+    }
+}
+
+// Returns one of the bytes in the set.
+char ByteSet::byte(size_t index) const { return bytes_[index]; }
+
+// Checks if a byte is in this set.
+bool ByteSet::contains(char ch) const { return table_[static_cast<unsigned char>(ch)]; }
+
+// Returns the number of bytes in the set.
+size_t ByteSet::size() const { return count_; }
+
+// Creates a scanner for a string. Both must outlive the scanner.
+Scanner::Scanner(string_view str, const ByteSet &set) : block_start_(0), kernel_(best_kernel()), mask_(0), set_(set), str_(str)
+{ mask_ = scan_block(str_.data(), std::min(BLOCK_SIZE, str_.size()), set_, kernel_); }
+
+// As next(), for when the answer isn't in the current block.
+size_t Scanner::next_block(size_t pos)
+{
+    if (pos >= block_start_ && pos < block_start_ + BLOCK_SIZE) pos = block_start_ + BLOCK_SIZE;   // Nothing left in this block, so move on to the next.
+    for (; pos < str_.size(); pos += BLOCK_SIZE)
+    {
+        block_start_ = pos;
+        mask_ = scan_block(str_.data() + pos, std::min(BLOCK_SIZE, str_.size() - pos), set_, kernel_);
+        if (mask_) return pos + bits::lowest_bit(mask_);
+    }
+    return string_view::npos;
+}
+
+// Returns the fastest kernel this CPU supports.
+Kernel best_kernel()
+{
+    static const Kernel best = (kernel_supported(Kernel::AVX2) ? Kernel::AVX2 : (kernel_supported(Kernel::SSE2) ? Kernel::SSE2 : Kernel::SCALAR));
+    return best;
+}
+
+// Finds the first byte at or after pos which is in the set, or std::string_view::npos if there isn't one.
+size_t find_first_of(string_view str, const ByteSet &set, size_t pos)
+{
+    if (pos >= str.size()) return string_view::npos;
+
+    // The C library's memchr() is already vectorized, and hard to beat for a single byte.
+    if (set.size() == 1)
+    {
+        const void* found = std::memchr(str.data() + pos, set.byte(0), str.size() - pos);
+        return (found ? static_cast<size_t>(static_cast<const char*>(found) - str.data()) : string_view::npos);
+    }
+
+    const Kernel kernel = best_kernel();
+    for (; pos < str.size(); pos += BLOCK_SIZE)
+    {
+        const uint64_t mask = scan_block(str.data() + pos, std::min(BLOCK_SIZE, str.size() - pos), set, kernel);
+        if (mask) return pos + bits::lowest_bit(mask);
+    }
+    return string_view::npos;
+}
+
+// Finds the first byte at or after pos which isn't plain ASCII (i.e. has its high bit set), or std::string_view::npos if there isn't one.
+size_t find_non_ascii(string_view str, size_t pos)
+{
+    const Kernel kernel = best_kernel();
+    for (; pos < str.size(); pos += BLOCK_SIZE)
+    {
+        const uint64_t mask = scan_non_ascii(str.data() + pos, std::min(BLOCK_SIZE, str.size() - pos), kernel);
+        if (mask) return pos + bits::lowest_bit(mask);
+    }
+    return string_view::npos;
+}
+
+// Finds the first place a string appears at or after pos.
+size_t find_string(string_view str, string_view to_find, size_t pos)
+{
+    if (to_find.empty()) return (pos <= str.size() ? pos : string_view::npos);
+    const ByteSet first{to_find.substr(0, 1)};
+    while (pos + to_find.size() <= str.size())
+    {
+        pos = find_first_of(str, first, pos);
+        if (pos == string_view::npos || pos + to_find.size() > str.size()) return string_view::npos;
+        if (!std::memcmp(str.data() + pos, to_find.data(), to_find.size())) return pos;
+        pos++;
+    }
+    return string_view::npos;
+}
+
+// Returns the name of a kernel.
+const char* kernel_name(Kernel kernel)
+{
+    switch(kernel)
+    {
+        case Kernel::SCALAR: return "scalar";
+        case Kernel::SSE2: return "SSE2";
+        case Kernel::AVX2: return "AVX2";
+    }
+    return "unknown";
+}
+
+// Checks if this CPU can run a kernel.
+bool kernel_supported(Kernel kernel)
+{
+    switch(kernel)
+    {
+        case Kernel::SCALAR: return true;
+#ifdef WESTGATE_SCAN_X86
+        case Kernel::SSE2: return true;
+        case Kernel::AVX2:
+        {
+            static const bool has_avx2 = cpu_has_avx2();
+            return has_avx2;
+        }
+#else
+        default: return false;
+#endif
+    }
+    return false;
+}
+
+// Scans up to BLOCK_SIZE bytes, returning a mask with a bit set for each byte that's in the set. Uses the best kernel for this CPU.
+uint64_t scan_block(const char* data, size_t length, const ByteSet &set) { return scan_block(data, length, set, best_kernel()); }
+
+// As above, but with a specific kernel. The kernel must be supported by this CPU.
+uint64_t scan_block(const char* data, size_t length, const ByteSet &set, Kernel kernel)
+{
+    if (length > BLOCK_SIZE) length = BLOCK_SIZE;
+    switch(kernel)
+    {
+#ifdef WESTGATE_SCAN_X86
+        case Kernel::SSE2: return scan_sse2(data, length, set);
+        case Kernel::AVX2: return scan_avx2(data, length, set);
+#endif
+        default: return scan_scalar(data, 0, length, set);
+    }
+}
+
+// Scans up to BLOCK_SIZE bytes, returning a mask with a bit set for each byte that isn't plain ASCII. The kernel must be supported by this CPU.
+uint64_t scan_non_ascii(const char* data, size_t length, Kernel kernel)
+{
+    if (length > BLOCK_SIZE) length = BLOCK_SIZE;
+    switch(kernel)
+    {
+#ifdef WESTGATE_SCAN_X86
+        case Kernel::SSE2: return scan_non_ascii_sse2(data, length);
+        case Kernel::AVX2: return scan_non_ascii_avx2(data, length);
+#endif
+        default: return scan_non_ascii_scalar(data, 0, length);
+    }
+}
+
+}   // namespace westgate::scan
@@ -0,0 +1,92 @@
+// util/scan.hpp -- Vectorized scanning for small sets of delimiter bytes, such as the brackets and spaces used by colour tags and conditional tags, and for
+// bytes which aren't plain ASCII.
+// SSE2 and AVX2 versions are used where the CPU supports them, chosen when the game starts, with a plain C++ version for everything else.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+#include "util/bits.hpp"
+
+namespace westgate::scan {
+
+constexpr size_t    BLOCK_SIZE =    64; // The number of bytes scanned at once, one for each bit of the mask that comes back.
+constexpr size_t    MAX_BYTES =     8;  // The most bytes a ByteSet can hold.
+
+enum class Kernel : uint8_t { SCALAR, SSE2, AVX2 };
+
+// A small set of bytes to scan for.
+class ByteSet {
+public:
+                ByteSet(std::string_view bytes);    // Creates a set of up to MAX_BYTES bytes.
+    char        byte(size_t index) const;   // Returns one of the bytes in the set.
+    bool        contains(char ch) const;    // Checks if a byte is in this set.
+    size_t      size() const;               // Returns the number of bytes in the set.
+
+private:
+    char        bytes_[MAX_BYTES];  // The bytes in the set.
+    uint8_t     count_;             // The number of bytes in the set.
+    bool        table_[256];        // A lookup table of which bytes are in the set, for the scalar code.
+};
+
+// Walks through a string finding each byte from a set in turn, keeping the mask for the current block so that short gaps between delimiters (like the words
+// in a sentence) don't mean scanning the same bytes again.
+class Scanner {
+public:
+                Scanner(std::string_view str, const ByteSet &set);  // Creates a scanner for a string. Both must outlive the scanner.
+    size_t      next(size_t pos);   // Finds the first byte at or after pos which is in the set, or std::string_view::npos if there isn't one.
+
+private:
+    size_t              next_block(size_t pos); // As next(), for when the answer isn't in the current block.
+
+    size_t              block_start_;   // Where the current block starts.
+    Kernel              kernel_;        // The kernel used to scan each block.
+    uint64_t            mask_;          // The mask for the current block.
+    const ByteSet&      set_;           // The bytes being scanned for.
+    std::string_view    str_;           // The string being scanned.
+};
+
+Kernel      best_kernel();  // Returns the fastest kernel this CPU supports.
+            // Finds the first byte at or after pos which is in the set, or std::string_view::npos if there isn't one.
+size_t      find_first_of(std::string_view str, const ByteSet &set, size_t pos = 0);
+            // Finds the first byte at or after pos which isn't plain ASCII (i.e. has its high bit set), or std::string_view::npos if there isn't one.
+size_t      find_non_ascii(std::string_view str, size_t pos = 0);
+size_t      find_string(std::string_view str, std::string_view to_find, size_t pos = 0);    // Finds the first place a string appears at or after pos.
+const char* kernel_name(Kernel kernel); // Returns the name of a kernel.
+bool        kernel_supported(Kernel kernel);    // Checks if this CPU can run a kernel.
+            // Scans up to BLOCK_SIZE bytes, returning a mask with a bit set for each byte that's in the set. Uses the best kernel for this CPU.
+uint64_t    scan_block(const char* data, size_t length, const ByteSet &set);
+            // As above, but with a specific kernel. The kernel must be supported by this CPU.
+uint64_t    scan_block(const char* data, size_t length, const ByteSet &set, Kernel kernel);
+            // Scans up to BLOCK_SIZE bytes, returning a mask with a bit set for each byte that isn't plain ASCII. The kernel must be supported by this CPU.
+uint64_t    scan_non_ascii(const char* data, size_t length, Kernel kernel);
+
+// Finds the first byte at or after pos which is in the set, or std::string_view::npos if there isn't one. This is called once per word when wrapping text,
+// so the common case of the answer being in the current block is kept inline.
+inline size_t Scanner::next(size_t pos)
+{
+    const size_t offset = pos - block_start_;   // Wraps around to a huge number if pos is before the current block.
+    if (offset < BLOCK_SIZE)
+    {
+        const uint64_t remaining = mask_ >> offset;
+        if (remaining) return pos + bits::lowest_bit(remaining);
+    }
+    return next_block(pos);
+}
+
+}   // namespace westgate::scan
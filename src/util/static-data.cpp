@@ -0,0 +1,38 @@
+// util/static-data.cpp -- Static game data (weather strings, name lists, etc.) which is compiled into the binary at build time by tools/datagen.cpp, so that it
+// doesn't need to be parsed every time the game starts. The data itself lives in the generated cmake/static-data.cpp file.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <filesystem>
+
+#include "util/filex.hpp"
+#include "util/static-data.hpp"
+#include "util/strx.hpp"
+
+using std::string_view;
+namespace fs = std::filesystem;
+
+namespace westgate::static_data {
+
+// Checks if a gamedata file still matches the hash of the version that was compiled into the binary.
+bool file_matches(const string_view filename, hash_wg hash)
+{
+    if (!fs::is_regular_file(filename)) return true;    // If the file is missing entirely, the compiled-in version is all we've got.
+    return strx::murmur3(filex::file_to_string(filename)) == hash;
+}
+
+}   // namespace westgate::static_data
@@ -0,0 +1,60 @@
+// util/static-data.hpp -- Static game data (weather strings, name lists, etc.) which is compiled into the binary at build time by tools/datagen.cpp, so that it
+// doesn't need to be parsed every time the game starts. Only available when built with the WESTGATE_STATIC_GAMEDATA CMake option.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+#include <cstdint>
+#include <string_view>
+
+namespace westgate::static_data {
+
+struct KeyVal { std::string_view key, val; };   // A key/value pair of strings.
+
+// A list of strings packed into a single buffer. String i runs from offsets[i] to offsets[i + 1], so there are size + 1 offsets.
+struct StringList { std::string_view data; const uint32_t* offsets; size_t size; };
+
+// Checks if a gamedata file still matches the hash of the version that was compiled into the binary. If it doesn't, the file has been modified since the
+// build (e.g. by a modder), and should be loaded from disk instead.
+bool    file_matches(const std::string_view filename, hash_wg hash);
+
+// The murmur3 hashes of the gamedata files, at the time they were compiled into the binary.
+extern const hash_wg    namegen_strings_yml_hash;
+extern const hash_wg    names_f_txt_hash;
+extern const hash_wg    names_m_txt_hash;
+extern const hash_wg    surname_a_txt_hash;
+extern const hash_wg    surname_b_txt_hash;
+extern const hash_wg    weather_yml_hash;
+
+// Data from misc/weather.yml
+extern const KeyVal             weather_strings[];      // The time and weather strings, sorted by key.
+extern const size_t             weather_strings_size;   // The number of entries in weather_strings.
+extern const KeyVal             weather_maps[];         // The weather change maps for each climate (WMAP0 - WMAP8, CLIMATE_WMAP0, etc.), already decompressed.
+extern const size_t             weather_maps_size;      // The number of entries in weather_maps.
+
+// Data from namegen/namegen-strings.yml
+extern const std::string_view   namegen_consonant_block;    // Already decompressed.
+extern const std::string_view   namegen_v4_template;
+extern const std::string_view   namegen_vowel_block;        // Already decompressed.
+extern const StringList         namegen_pv3_c, namegen_pv3_d, namegen_pv3_e, namegen_pv3_f, namegen_pv3_i, namegen_pv3_k, namegen_pv3_v, namegen_pv3_x;
+
+// Data from the namegen/*.txt name lists.
+extern const StringList         names_f, names_m, surname_a, surname_b;
+
+}   // namespace westgate::static_data
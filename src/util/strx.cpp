@@ -20,10 +20,14 @@
 #include <iomanip>
 #include <ios>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #include "3rdparty/murmurhash3/MurmurHash3.h"
+#include "util/scan.hpp"
 #include "util/strx.hpp"
+#include "util/styled-text.hpp"
+#include "util/utf8.hpp"
 
 using std::string;
 using std::string_view;
@@ -38,6 +42,8 @@ namespace westgate::strx {
 void check_hash_collision(const string_view str, hash_wg hash)
 {
     static std::map<hash_wg, string> backward_hash_map_;
+    static std::mutex backward_hash_mutex_; // Hashes can be generated on worker threads while loading.
+    std::lock_guard<std::mutex> lock(backward_hash_mutex_);
     auto result_b = backward_hash_map_.find(hash);
     if (result_b == backward_hash_map_.end())
     {
@@ -50,62 +56,26 @@ void check_hash_collision(const string_view str, hash_wg hash)
 #endif  // WESTGATE_BUILD_DEBUG
 
 // Strips all ANSI colour tags like {M} from a string.
-string ansi_strip(const string_view str)
-{
-    string result = string{str};
-    while(true)
-    {
-        size_t found_open = result.find_first_of('{');
-        size_t found_closed = result.find_first_of('}', found_open);
-        if (found_open == string::npos || found_closed == string::npos) return result;
-        result = result.substr(0, found_open) + result.substr(found_closed + 1);
-    }
-}
+string ansi_strip(const string_view str) { return StyledText{str}.plain(); }
 
-// Returns the length of a specified string, not counting the ANSI colour tags like {G} or {kR}.
-size_t ansi_strlen(const string_view str)
-{ return ansi_strip(str).length(); }
+// Returns how many columns a specified string takes up when printed, not counting the ANSI colour tags like {G} or {kR}.
+size_t ansi_strlen(const string_view str) { return StyledText{str}.width(); }
 
 // Splits an ANSI-tagged string across multiple lines of text.
 vector<string> ansi_vector_split(const string_view str, size_t line_length)
 {
-    string current_line, last_tag;
-    vector<string> result, words = string_explode(str, " ");
-    size_t current_pos = 0;
-
-    while(words.size())
+    vector<WrappedLine> lines;
+    wrap_lines(str, line_length, lines);
+    vector<string> result;
+    result.reserve(lines.size());
+    for (auto &line : lines)
     {
-        string word = words.at(0);
-        words.erase(words.begin());
-
-        // Determine if any ANSI tags are within this word. If so, record the last tag. Then measure the word length.
-        size_t found_open = word.find_last_of('{');
-        size_t found_closed = word.find_first_of('}', found_open);
-        size_t word_len = 0;
-        bool newline_tag = false;
-        if (found_open != string::npos && found_closed != string::npos)
-        {
-            string tag_found = word.substr(found_open, found_closed - found_open + 1);
-            if (!tag_found.compare("{nl}")) newline_tag = true;
-            else last_tag = tag_found;
-            word_len = ansi_strlen(word);
-        }
-        else word_len = word.size();
-
-        // Decide whether or not we're starting a new line.
-        if ((current_pos && (current_pos + word_len >= line_length)) || newline_tag)
-        {
-            result.push_back(current_line);
-            current_line = (newline_tag ? "  " : "") + last_tag + word;
-            current_pos = word_len + (newline_tag ? 3 : 1);
-        }
-        else
-        {
-            current_line += (current_pos  ? " " : "") + word;
-            current_pos += word_len + 1;
-        }
+        string &line_str = result.emplace_back();
+        line_str.reserve(line.length + line.tag.size() + 2);
+        if (line.paragraph) line_str += "  ";
+        line_str += line.tag;
+        line_str += str.substr(line.start, line.length);
     }
-    if (current_line.size()) result.push_back(current_line);
     return result;
 }
 
@@ -160,43 +130,28 @@ string decode_compressed_string(const string_view str)
 // Find and replace one string with another.
 bool find_and_replace(string& input, const string_view to_find, const string_view to_replace)
 {
-    string::size_type pos = 0;
-    const string::size_type find_len = to_find.length(), replace_len = to_replace.length();
-    if (find_len == 0) return false;
-    bool found = false;
-    while ((pos = input.find(to_find, pos)) != string::npos)
+    if (to_find.empty()) return false;
+    size_t pos = scan::find_string(input, to_find);
+    if (pos == string::npos) return false;
+
+    // Build the result in one pass, rather than shifting the rest of the string along for every replacement.
+    string result;
+    result.reserve(input.size());
+    size_t copied = 0;
+    while (pos != string::npos)
     {
-        found = true;
-        input.replace(pos, find_len, to_replace);
-        pos += replace_len;
+        result.append(input, copied, pos - copied);
+        result += to_replace;
+        copied = pos + to_find.size();
+        pos = scan::find_string(input, to_find, copied);
     }
-    return found;
+    result.append(input, copied);
+    input = std::move(result);
+    return true;
 }
 
 // 'Flattens' ANSI tags, by erasing redundant tags in the string.
-string flatten_tags(const string_view str)
-{
-    string output, last_tag, to_check = string{str};
-    while(true)
-    {
-        size_t tag_open = to_check.find_first_of('{');
-        size_t tag_closed = to_check.find_first_of('}', tag_open);
-        if (tag_open == string::npos || tag_closed == string::npos)
-        {
-            output += to_check;
-            break;
-        }
-        if (const string tag_found = to_check.substr(tag_open + 1, tag_closed - tag_open - 1);
-            tag_found.compare(last_tag))
-        {
-            last_tag = tag_found;
-            output += to_check.substr(0, tag_closed + 1);
-        }
-        else output += to_check.substr(0, tag_open);
-        to_check = to_check.substr(tag_closed + 1);
-    }
-    return output;
-}
+string flatten_tags(const string_view str) { return StyledText{str}.tagged(); }
 
 // Converts a float or double to a string.
 string ftos(double num, int precision)
@@ -206,6 +161,42 @@ string ftos(double num, int precision)
     return ss.str();
 }
 
+// Converts a string into a quoted JSON string, escaping anything that needs it.
+string json_quote(const string_view str)
+{
+    string result;
+    json_quote(str, result);
+    return result;
+}
+
+// As above, but adds the quoted string onto the end of an existing string.
+void json_quote(const string_view str, string &out)
+{
+    static constexpr char hex_digits[] = "0123456789abcdef";
+    out.reserve(out.size() + str.size() + 2);
+    out += '"';
+    for (const char ch : str)
+    {
+        switch(ch)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex_digits[ch >> 4];
+                    out += hex_digits[ch & 15];
+                }
+                else out += ch;
+        }
+    }
+    out += '"';
+}
+
 // Hashes a string with MurmurHash3.
 hash_wg murmur3(const string_view str)
 {
@@ -275,20 +266,24 @@ string number_to_text(int64_t num)
 // whether the bool is true or false.
 void process_conditional_tags(string& str, const string_view tag, bool active)
 {
-    string tag_str = string{tag};
-    do
+    static const scan::ByteSet closer{"]"};
+    const string opener = "[" + string{tag};
+    size_t search_from = 0;
+    while (true)
     {
-        const size_t start = str.find("[" + tag_str);
-        const size_t end = str.find("]", start);
+        const size_t start = scan::find_string(str, opener, search_from);
+        const size_t end = scan::find_first_of(str, closer, start);
         if (start == string::npos || end == string::npos) return;
         if (active)
         {
             const size_t insert_start = start + tag.size() + 2;
-            const string insert = str.substr(insert_start, end - insert_start);
-            str = str.substr(0, start) + insert + str.substr(end + 1);
+            str.replace(start, end + 1 - start, str, insert_start, end - insert_start);
         }
-        else str = str.substr(0, start) + str.substr(end + 1);
-    } while(true);
+        else str.erase(start, end + 1 - start);
+
+        // Nothing before the tag matched, but the kept text (or the text after a removed tag) could complete a partial tag just before it.
+        search_from = (start > opener.size() ? start - opener.size() : 0);
+    }
 }
 
 // Converts a string to lower-case.
@@ -311,21 +306,80 @@ string str_toupper(const string_view str)
 vector<string> string_explode(const string_view str, const string_view separator)
 {
     vector<string> results;
-
-    string::size_type pos = str.find(separator, 0);
-    const size_t pit = separator.length();
-    string line = string{str};
-
-    while(pos != string::npos)
+    if (separator.empty())
     {
-        if (pos == 0) results.push_back("");
-        else results.push_back(line.substr(0, pos));
-        line.erase(0, pos + pit);
-        pos = line.find(separator, 0);
+        results.emplace_back(str);
+        return results;
     }
-    results.push_back(line);
 
+    size_t start = 0;
+    for (size_t pos = scan::find_string(str, separator); pos != string::npos; pos = scan::find_string(str, separator, start))
+    {
+        results.emplace_back(str.substr(start, pos - start));
+        start = pos + separator.size();
+    }
+    results.emplace_back(str.substr(start));
     return results;
 }
 
+// Word-wraps an ANSI-tagged string into lines shorter than line_length, filling the provided vector with where each line is, and returning how many lines
+// there are. Nothing is allocated, apart from the vector growing if it's not big enough already.
+size_t wrap_lines(const string_view str, size_t line_length, vector<WrappedLine> &lines)
+{
+    static const scan::ByteSet word_delimiters{" {"}, tag_delimiters{" }"};
+    scan::Scanner word_scanner{str, word_delimiters};
+    const bool ascii = (scan::find_non_ascii(str) == string_view::npos);   // Plain ASCII is one column per byte, so words don't need measuring one by one.
+    lines.clear();
+    string_view active_tag;     // The last colour tag seen so far.
+    WrappedLine line{0, 0, {}, false};
+    size_t line_pos = 0;        // The width of the line so far, counting a space after each word.
+    size_t pos = 0;
+    while (true)
+    {
+        // Measure the next word, skipping over any colour tags in it. Words are separated by single spaces, so two spaces in a row make an empty word.
+        const size_t word_start = pos;
+        const string_view word_tag = active_tag;
+        size_t word_width = 0, text_start = word_start;
+        bool new_paragraph = false;
+        while (pos < str.size() && str[pos] != ' ')
+        {
+            if (str[pos] == '{')
+            {
+                const size_t closer = scan::find_first_of(str, tag_delimiters, pos + 1);
+                if (closer != string_view::npos && str[closer] == '}')
+                {
+                    const string_view tag = str.substr(pos, closer - pos + 1);
+                    if (tag == "{nl}")
+                    {
+                        new_paragraph = true;
+                        if (pos == word_start) text_start = closer + 1;  // The tag itself doesn't need to be kept, if it's at the start of the word.
+                    }
+                    else active_tag = tag;
+                    pos = closer + 1;
+                    continue;
+                }
+            }
+            // Anything else runs up to the next space or tag.
+            const size_t next = std::min(word_scanner.next(pos + 1), str.size());
+            word_width += (ascii ? next - pos : utf8::width(str.substr(pos, next - pos)));
+            pos = next;
+        }
+
+        // Start a new line if the word doesn't fit on this one, or if there's a {nl} tag.
+        if ((line_pos && line_pos + word_width >= line_length) || new_paragraph)
+        {
+            lines.push_back(line);
+            line = {text_start, 0, word_tag, new_paragraph};
+            line_pos = word_width + (new_paragraph ? 3 : 1);
+        }
+        else line_pos += word_width + 1;
+        line.length = pos - line.start;
+
+        if (pos >= str.size()) break;
+        pos++;  // Skip the space after the word.
+    }
+    if (line.length || line.paragraph) lines.push_back(line);
+    return lines.size();
+}
+
 }   // namespace westgate::strx
@@ -26,8 +26,16 @@ namespace westgate::strx {
 constexpr unsigned int  CL_MODE_USE_AND = 1;   // Use 'and' for the last entry in comma_list().
 constexpr unsigned int  CL_MODE_USE_OR =  2;   // Use 'or' for the last entry in comma_list();
 
+// A line of text found by wrap_lines(), given as its position within the string that was wrapped.
+struct WrappedLine {
+    size_t              start;      // Where the line starts in the string.
+    size_t              length;     // The length of the line in the string, including any colour tags.
+    std::string_view    tag;        // The colour tag in effect where the line starts (e.g. "{G}"), if any, which needs to be printed before it.
+    bool                paragraph;  // Does this line start a new paragraph, after a {nl} tag? If so, it should be indented by two spaces.
+};
+
 std::string ansi_strip(const std::string_view str); // Strips all ANSI colour tags like {M} from a string.
-size_t      ansi_strlen(const std::string_view str);    // Returns the length of a specified string, not counting the ANSI colour tags like {G}.
+size_t      ansi_strlen(const std::string_view str);    // Returns how many columns a string takes up when printed, not counting the ANSI colour tags like {G}.
                             // Splits an ANSI-tagged string across multiple lines of text.
 std::vector<std::string>    ansi_vector_split(const std::string_view str, size_t line_length);
 std::string comma_list(std::vector<std::string> vec, unsigned int mode = 0);    // Converts a vector to a comma-separated list.
@@ -36,6 +44,8 @@ std::string decode_compressed_string(const std::string_view str);   // Decodes a
 bool        find_and_replace(std::string& input, const std::string_view to_find, const std::string_view to_replace);
 std::string flatten_tags(const std::string_view str);   // 'Flattens' ANSI tags, by erasing redundant tags in the string.
 std::string ftos(double num, int precision = 1);    // Converts a float or double to a string.
+std::string json_quote(const std::string_view str); // Converts a string into a quoted JSON string, escaping anything that needs it.
+void        json_quote(const std::string_view str, std::string &out);   // As above, but adds the quoted string onto the end of an existing string.
 hash_wg     murmur3(const std::string_view str);    // Hashes a string with MurmurHash3.
 std::string number_to_text(int64_t num);    // Converts a number (e.g. 123) into a string (e.g. "one hundred and twenty-three").
             // Allows adding conditional tags to a string in the form of [tag_name:conditional text here] and either including or removing the conditional text
@@ -44,5 +54,8 @@ void        process_conditional_tags(std::string& str, const std::string_view ta
 std::string str_tolower(const std::string_view str);    // Converts a string to lower-case.
 std::string str_toupper(const std::string_view str);    // Converts a string to upper-case.
 std::vector<std::string>    string_explode(const std::string_view str, const std::string_view separator = " "); // String split/explode function.
+            // Word-wraps an ANSI-tagged string into lines shorter than line_length, filling the provided vector with where each line is, and returning how many
+            // lines there are. Nothing is allocated, apart from the vector growing if it's not big enough already.
+size_t      wrap_lines(const std::string_view str, size_t line_length, std::vector<WrappedLine> &lines);
 
 }   // namespace westgate::strx
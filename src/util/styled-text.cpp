@@ -0,0 +1,152 @@
+// util/styled-text.cpp -- Text with colour tags like {G} parsed into a list of styled spans, so it can be measured, wrapped and printed without scanning the
+// tags again each time.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "util/strx.hpp"
+#include "util/styled-text.hpp"
+#include "util/utf8.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace westgate {
+
+namespace {
+
+// Applies a colour tag (without the braces) to a style, returning false if the tag isn't valid.
+bool apply_tag(StyledText::Style &style, const string_view tag)
+{
+    static constexpr string_view colours = "0krgybmcwKRGYBMCW";
+    if (!tag.size() || tag.size() > 2) return false;
+    for (auto ch : tag)
+        if (colours.find(ch) == string_view::npos) return false;
+
+    // {0} on its own resets everything. Otherwise, the first letter is the foreground colour, and the second (if any) is the background.
+    if (tag == "0")
+    {
+        style = StyledText::Style{};
+        return true;
+    }
+    style.fg = (tag[0] == '0' ? 0 : tag[0]);
+    if (tag.size() == 2) style.bg = (tag[1] == '0' ? 0 : tag[1]);
+    return true;
+}
+
+}   // anonymous namespace
+
+// Parses a string containing colour tags.
+StyledText::StyledText(const string_view str) { parse(str); }
+
+// Checks if there's no text at all.
+bool StyledText::empty() const { return source_.empty(); }
+
+// Replaces the text with a new string containing colour tags. The memory already allocated is reused, so one StyledText can be parsed into over and over.
+void StyledText::parse(const string_view str)
+{
+    source_.assign(str.data(), str.size());
+    spans_.clear();
+    Style style;
+    size_t text_start = 0;
+    auto add_span = [this, &style](size_t start, size_t end, SpanType type)
+        { spans_.push_back({style, static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), type}); };
+
+    while (true)
+    {
+        const size_t opener = source_.find('{', text_start);
+        if (opener == string::npos) break;
+        const size_t closer = source_.find('}', opener + 1);
+        if (closer == string::npos) break;
+        if (opener > text_start) add_span(text_start, opener, SpanType::TEXT);
+        const string_view tag = string_view{source_}.substr(opener + 1, closer - opener - 1);
+        if (tag == "nl") add_span(opener, closer + 1, SpanType::LINE_BREAK);
+        else if (!apply_tag(style, tag)) add_span(opener, closer + 1, SpanType::INVALID_TAG);
+        text_start = closer + 1;
+    }
+    if (text_start < source_.size()) add_span(text_start, source_.size(), SpanType::TEXT);
+
+    // A colour change at the very end still matters when this text is joined onto something else, so it gets an empty span of its own.
+    Style last_style;
+    for (auto it = spans_.rbegin(); it != spans_.rend(); ++it)
+    {
+        if (it->type != SpanType::TEXT) continue;
+        last_style = it->style;
+        break;
+    }
+    if (style != last_style) add_span(source_.size(), source_.size(), SpanType::TEXT);
+}
+
+// Returns the text without any colour tags.
+string StyledText::plain() const
+{
+    string result;
+    result.reserve(source_.size());
+    for (auto &span : spans_)
+        if (span.type == SpanType::TEXT) result += view(span);
+    return result;
+}
+
+// Returns the source text, tags and all.
+const string& StyledText::source() const { return source_; }
+
+// Returns the spans that make up the text.
+const vector<StyledText::Span>& StyledText::spans() const { return spans_; }
+
+// Converts the text back into a string with colour tags, leaving out any tags which don't change anything.
+string StyledText::tagged() const
+{
+    string result;
+    result.reserve(source_.size());
+    Style style;
+    for (auto &span : spans_)
+    {
+        if (span.type == SpanType::TEXT)
+        {
+            result += tag_change(style, span.style);
+            style = span.style;
+        }
+        result += view(span);
+    }
+    return result;
+}
+
+// Returns the colour tag which changes from one style to another.
+string StyledText::tag_change(const Style &from, const Style &to)
+{
+    if (from == to) return "";
+    if (to == Style{}) return "{0}";
+    if (to.bg == from.bg && to.fg) return string{'{', to.fg, '}'};
+    return string{'{', (to.fg ? to.fg : '0'), (to.bg ? to.bg : '0'), '}'};
+}
+
+// Returns the source text of a span.
+string_view StyledText::view(const Span &span) const { return string_view{source_}.substr(span.start, span.length); }
+
+// Returns how many columns the text takes up when printed, not counting the colour tags.
+size_t StyledText::width() const
+{
+    size_t result = 0;
+    for (auto &span : spans_)
+        if (span.type == SpanType::TEXT) result += utf8::width(view(span));
+    return result;
+}
+
+// Splits the text across multiple lines, each shorter than line_length. Each line starts with whatever colour tag it needs.
+vector<string> StyledText::wrap(size_t line_length) const { return strx::ansi_vector_split(source_, line_length); }
+
+}   // namespace westgate
@@ -0,0 +1,67 @@
+// util/styled-text.hpp -- Text with colour tags like {G} parsed into a list of styled spans, so it can be measured, wrapped and printed without scanning the
+// tags again each time.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+namespace westgate {
+
+class StyledText
+{
+public:
+    // The colours in effect for a span of text. Colours are stored as their tag letters (e.g. 'G'), with 0 meaning the terminal's default colour.
+    struct Style {
+        char    fg = 0; // The foreground colour.
+        char    bg = 0; // The background colour.
+
+        bool    operator==(const Style &other) const { return fg == other.fg && bg == other.bg; }
+        bool    operator!=(const Style &other) const { return !(*this == other); }
+    };
+
+    enum class SpanType : uint8_t { TEXT, LINE_BREAK, INVALID_TAG };
+
+    // A span of the source text. Spans refer to the source by position rather than with a string_view, so they stay valid when the StyledText is copied.
+    struct Span {
+        Style       style;  // The colours this span is printed in.
+        uint32_t    start;  // Where this span starts in the source text.
+        uint32_t    length; // The length of this span, in the source text.
+        SpanType    type;   // Whether this span is text, a {nl} line break, or a tag that couldn't be understood (which is kept, so it can be reported).
+    };
+
+                        StyledText() = default;
+                        StyledText(std::string_view str);   // Parses a string containing colour tags.
+    bool                empty() const;  // Checks if there's no text at all.
+                        // Replaces the text with a new string containing colour tags. The memory already allocated is reused.
+    void                parse(std::string_view str);
+    std::string         plain() const;  // Returns the text without any colour tags.
+    const std::string&  source() const; // Returns the source text, tags and all.
+    const std::vector<Span>&    spans() const;  // Returns the spans that make up the text.
+    std::string         tagged() const; // Converts the text back into a string with colour tags, leaving out any tags which don't change anything.
+    static std::string  tag_change(const Style &from, const Style &to); // Returns the colour tag which changes from one style to another.
+    std::string_view    view(const Span &span) const;   // Returns the source text of a span.
+    size_t              width() const;  // Returns how many columns the text takes up when printed, not counting the colour tags.
+                        // Splits the text across multiple lines, each shorter than line_length. Each line starts with whatever colour tag it needs.
+    std::vector<std::string>    wrap(size_t line_length) const;
+
+private:
+    std::string         source_;    // The source text, including the colour tags.
+    std::vector<Span>   spans_;     // The spans that make up the text, in order.
+};
+
+}   // namespace westgate
@@ -0,0 +1,133 @@
+// util/task-graph.cpp -- A small dependency graph of tasks, which are run on a ThreadPool as soon as everything they depend on has finished.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "util/task-graph.hpp"
+#include "util/thread-pool.hpp"
+#include "util/timer.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+
+namespace westgate {
+
+// Constructor, creates an empty task graph.
+TaskGraph::TaskGraph() : pool_(nullptr) { }
+
+// Adds a task to the graph, which will run after all of its dependencies have finished. Returns the task's ID.
+size_t TaskGraph::add(const string_view name, std::function<void()> func, std::vector<size_t> dependencies)
+{
+    if (pool_) throw runtime_error("Attempt to add task to a graph which has already started!");
+    const size_t id = tasks_.size();
+    for (auto dep : dependencies)
+    {
+        if (dep >= id) throw runtime_error("Invalid task dependency: " + string{name});
+        tasks_.at(dep).dependents.push_back(id);
+    }
+    tasks_.push_back({{}, static_cast<unsigned int>(dependencies.size()), false, nullptr, std::move(func), string{name}, 0});
+    return id;
+}
+
+// Checks if a task has finished (or failed), without waiting.
+bool TaskGraph::done(size_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.at(id).done;
+}
+
+// Returns the name of a task.
+const string& TaskGraph::name(size_t id) const { return tasks_.at(id).name; }
+
+// Runs a task, then queues up any dependents that are now ready.
+void TaskGraph::run(size_t id)
+{
+    Task &task = tasks_.at(id);
+    Timer task_timer;
+
+    // If a dependency failed, this task inherits the error rather than running at all.
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error = task.error;
+    }
+    if (!error)
+    {
+        try { task.func(); }
+        catch (...) { error = std::current_exception(); }
+    }
+
+    // Everything here happens under the lock: once the last task is marked done, a waiting thread is free to destroy the graph as soon as the lock is
+    // released, so nothing may be touched after that.
+    std::lock_guard<std::mutex> lock(mutex_);
+    task.time_taken = task_timer.elapsed();
+    task.error = error;
+    task.done = true;
+    for (auto dep_id : task.dependents)
+    {
+        Task &dependent = tasks_.at(dep_id);
+        if (error && !dependent.error) dependent.error = error;
+        if (!--dependent.deps_remaining) pool_->submit([this, dep_id] { run(dep_id); });
+    }
+    condition_.notify_all();
+}
+
+// Returns the number of tasks in the graph.
+size_t TaskGraph::size() const { return tasks_.size(); }
+
+// Starts running the tasks. No more tasks can be added after this.
+void TaskGraph::start(ThreadPool &pool)
+{
+    if (pool_) throw runtime_error("Attempt to start a task graph twice!");
+    pool_ = &pool;
+
+    // The first tasks can finish and free up their dependents while this loop is still running, so the lock is held to stop those being queued twice.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < tasks_.size(); i++)
+        if (!tasks_.at(i).deps_remaining) pool_->submit([this, i] { run(i); });
+}
+
+// Returns the time taken to run a task, in milliseconds. Only valid once the task is done.
+unsigned int TaskGraph::time_taken(size_t id) const { return tasks_.at(id).time_taken; }
+
+// Waits for a task to finish. If the task (or any of its dependencies) threw an exception, it is rethrown here.
+void TaskGraph::wait(size_t id)
+{
+    if (!pool_) throw runtime_error("Attempt to wait on a task graph which hasn't started!");
+    std::unique_lock<std::mutex> lock(mutex_);
+    Task &task = tasks_.at(id);
+    condition_.wait(lock, [&task] { return task.done; });
+    if (task.error) std::rethrow_exception(task.error);
+}
+
+// Waits for every task to finish, rethrowing the first exception if requested.
+void TaskGraph::wait_all(bool rethrow)
+{
+    if (!pool_) return;
+    std::exception_ptr first_error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto &task : tasks_)
+        {
+            condition_.wait(lock, [&task] { return task.done; });
+            if (task.error && !first_error) first_error = task.error;
+        }
+    }
+    if (rethrow && first_error) std::rethrow_exception(first_error);
+}
+
+}   // namespace westgate
@@ -0,0 +1,63 @@
+// util/task-graph.hpp -- A small dependency graph of tasks, which are run on a ThreadPool as soon as everything they depend on has finished.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+namespace westgate {
+
+class ThreadPool;   // defined in util/thread-pool.hpp
+
+class TaskGraph {
+public:
+                TaskGraph();    // Constructor, creates an empty task graph.
+                // Adds a task to the graph, which will run after all of its dependencies have finished. Returns the task's ID.
+    size_t      add(const std::string_view name, std::function<void()> func, std::vector<size_t> dependencies = {});
+    bool        done(size_t id);    // Checks if a task has finished (or failed), without waiting.
+    const std::string&  name(size_t id) const;  // Returns the name of a task.
+    size_t      size() const;       // Returns the number of tasks in the graph.
+    void        start(ThreadPool &pool);    // Starts running the tasks. No more tasks can be added after this.
+    unsigned int    time_taken(size_t id) const;    // Returns the time taken to run a task, in milliseconds. Only valid once the task is done.
+    void        wait(size_t id);    // Waits for a task to finish. If the task (or any of its dependencies) threw an exception, it is rethrown here.
+    void        wait_all(bool rethrow = true);  // Waits for every task to finish, rethrowing the first exception if requested.
+
+private:
+    struct Task {
+        std::vector<size_t>     dependents;     // Tasks which are waiting on this one.
+        unsigned int            deps_remaining; // The number of dependencies which haven't finished yet.
+        bool                    done;           // Has this task finished (or failed)?
+        std::exception_ptr      error;          // The exception thrown by this task or one of its dependencies, if any.
+        std::function<void()>   func;           // The code to run.
+        std::string             name;           // The name of this task, for logging.
+        unsigned int            time_taken;     // The time taken to run this task, in milliseconds.
+    };
+
+    void    run(size_t id); // Runs a task, then queues up any dependents that are now ready.
+
+    std::condition_variable condition_; // Used to wake up any threads waiting on a task.
+    std::mutex              mutex_;     // Guards the task states.
+    ThreadPool*             pool_;      // The pool that the tasks are running on.
+    std::vector<Task>       tasks_;     // All the tasks in this graph.
+};
+
+}   // namespace westgate
@@ -0,0 +1,98 @@
+// util/text-template.cpp -- Text containing conditional sections like [daydawn:...] or [inside:...], compiled once into a list of segments so that showing it
+// is just a matter of joining together the segments whose conditions are currently true.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "util/scan.hpp"
+#include "util/text-template.hpp"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace westgate {
+
+// Compiles a string containing conditional tags.
+TextTemplate::TextTemplate(const string_view str) : source_(str)
+{
+    split(source_, [this](const string_view text, uint16_t conditions) {
+        if (!segments_.empty() && segments_.back().conditions == conditions) segments_.back().text += text;
+        else segments_.push_back({conditions, string{text}});
+    });
+}
+
+// Checks if there's no text at all.
+bool TextTemplate::empty() const { return source_.empty(); }
+
+// Joins together the segments which are shown under the specified conditions.
+string TextTemplate::render(uint16_t active) const
+{
+    string result;
+    result.reserve(source_.size());
+    for (auto &segment : segments_)
+        if (shown(segment.conditions, active)) result += segment.text;
+    return result;
+}
+
+// Returns the compiled segments.
+const vector<TextTemplate::Segment>& TextTemplate::segments() const { return segments_; }
+
+// Checks if a segment with the specified conditions is shown under the active conditions.
+bool TextTemplate::shown(uint16_t conditions, uint16_t active) { return conditions == ALWAYS || (conditions & active); }
+
+// Returns the source text, tags and all.
+const string& TextTemplate::source() const { return source_; }
+
+// Splits a string into sections, calling add_section for each with the conditions it depends on. Tags which aren't recognized are left as text.
+void TextTemplate::split(const string_view str, const std::function<void(string_view, uint16_t)> &add_section)
+{
+    static const scan::ByteSet opener{"["}, closer{"]"};
+    size_t pos = 0, text_start = 0;
+    while (true)
+    {
+        // Conditional tags look like [name:text], with a lower-case name.
+        const size_t start = scan::find_first_of(str, opener, pos);
+        if (start == string_view::npos) break;
+        size_t name_end = start + 1;
+        while (name_end < str.size() && str[name_end] >= 'a' && str[name_end] <= 'z') name_end++;
+        const size_t end = (name_end < str.size() && str[name_end] == ':' ? scan::find_first_of(str, closer, name_end) : string_view::npos);
+        const uint16_t conditions = (end == string_view::npos ? uint16_t{ALWAYS} : tag_conditions(str.substr(start + 1, name_end - start - 1)));
+        if (conditions == ALWAYS)
+        {
+            pos = start + 1;
+            continue;
+        }
+
+        if (start > text_start) add_section(str.substr(text_start, start - text_start), ALWAYS);
+        if (end > name_end + 1) add_section(str.substr(name_end + 1, end - name_end - 1), conditions);
+        pos = text_start = end + 1;
+    }
+    if (text_start < str.size()) add_section(str.substr(text_start), ALWAYS);
+}
+
+// Returns the conditions for a tag name (e.g. daydawn), or ALWAYS if it's not a conditional tag.
+uint16_t TextTemplate::tag_conditions(const string_view tag)
+{
+    static constexpr struct { string_view name; uint16_t conditions; } tags[] = { { "dawn", DAWN }, { "day", DAY }, { "dusk", DUSK }, { "night", NIGHT },
+        { "daydawn", DAY | DAWN }, { "nightdusk", NIGHT | DUSK }, { "outside", OUTSIDE }, { "inside", INSIDE }, { "winter", WINTER }, { "spring", SPRING },
+        { "summer", SUMMER }, { "autumn", AUTUMN } };
+    for (auto &entry : tags)
+        if (entry.name == tag) return entry.conditions;
+    return ALWAYS;
+}
+
+}   // namespace westgate
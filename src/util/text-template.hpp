@@ -0,0 +1,56 @@
+// util/text-template.hpp -- Text containing conditional sections like [daydawn:...] or [inside:...], compiled once into a list of segments so that showing it
+// is just a matter of joining together the segments whose conditions are currently true.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+#include <functional>
+
+namespace westgate {
+
+class TextTemplate
+{
+public:
+    // The conditions a section of text can depend on. Each is a single bit, so one tag can stand for several at once, such as [daydawn:...].
+    enum Condition : uint16_t { ALWAYS = 0, DAWN = 1 << 0, DAY = 1 << 1, DUSK = 1 << 2, NIGHT = 1 << 3, OUTSIDE = 1 << 4, INSIDE = 1 << 5, WINTER = 1 << 6,
+        SPRING = 1 << 7, SUMMER = 1 << 8, AUTUMN = 1 << 9 };
+
+    // A piece of the text, and the conditions under which it's shown.
+    struct Segment {
+        uint16_t    conditions; // The segment is shown if any of these conditions are true, or always if this is ALWAYS.
+        std::string text;       // The text of this segment.
+    };
+
+                    TextTemplate() = default;
+                    TextTemplate(std::string_view str); // Compiles a string containing conditional tags.
+    bool            empty() const;  // Checks if there's no text at all.
+    std::string     render(uint16_t active) const;  // Joins together the segments which are shown under the specified conditions.
+    const std::vector<Segment>& segments() const;   // Returns the compiled segments.
+    static bool     shown(uint16_t conditions, uint16_t active);    // Checks if a segment with the specified conditions is shown under the active conditions.
+    const std::string&  source() const; // Returns the source text, tags and all.
+                    // Splits a string into sections, calling add_section for each with the conditions it depends on. Unrecognized tags are left as text.
+    static void     split(std::string_view str, const std::function<void(std::string_view, uint16_t)> &add_section);
+    static uint16_t tag_conditions(std::string_view tag);   // Returns the conditions for a tag name (e.g. daydawn), or ALWAYS if it's not a conditional tag.
+
+private:
+    std::vector<Segment>    segments_;  // The compiled segments, in order.
+    std::string             source_;    // The source text, including the conditional tags.
+};
+
+}   // namespace westgate
@@ -0,0 +1,74 @@
+// util/thread-pool.cpp -- A simple pool of worker threads, which run queued jobs in the background.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "util/thread-pool.hpp"
+
+namespace westgate {
+
+// Starts the worker threads. If threads is 0, the number will be chosen based on the hardware.
+ThreadPool::ThreadPool(unsigned int threads) : stopping_(false)
+{
+    if (!threads) threads = std::thread::hardware_concurrency();
+    if (!threads) threads = 2;  // hardware_concurrency() is allowed to return 0 if it can't tell.
+    for (unsigned int i = 0; i < threads; i++)
+        workers_.emplace_back(&ThreadPool::worker, this);
+}
+
+// Finishes any queued jobs, then stops the worker threads.
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+// Adds a job to the queue, to be run on the next available worker thread.
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push(std::move(job));
+    }
+    condition_.notify_one();
+}
+
+// Returns the number of worker threads in this pool.
+unsigned int ThreadPool::threads() const { return workers_.size(); }
+
+// The main loop for each worker thread.
+void ThreadPool::worker()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;  // Only exit once the queue has been emptied.
+            job = std::move(jobs_.front());
+            jobs_.pop();
+        }
+        job();  // Jobs are expected to handle their own exceptions; see TaskGraph.
+    }
+}
+
+}   // namespace westgate
@@ -0,0 +1,47 @@
+// util/thread-pool.hpp -- A simple pool of worker threads, which run queued jobs in the background.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace westgate {
+
+class ThreadPool {
+public:
+            ThreadPool(unsigned int threads = 0);   // Starts the worker threads. If threads is 0, the number will be chosen based on the hardware.
+            ~ThreadPool();  // Finishes any queued jobs, then stops the worker threads.
+    void    submit(std::function<void()> job);  // Adds a job to the queue, to be run on the next available worker thread.
+    unsigned int    threads() const;    // Returns the number of worker threads in this pool.
+
+private:
+    void    worker();   // The main loop for each worker thread.
+
+    std::condition_variable     condition_; // Used to wake up the worker threads when there's a job waiting.
+    std::queue<std::function<void()>>   jobs_;  // Any jobs that are waiting to run.
+    std::mutex                  mutex_;     // Guards the job queue.
+    bool                        stopping_;  // Set when the pool is shutting down.
+    std::vector<std::thread>    workers_;   // The worker threads.
+};
+
+}   // namespace westgate
@@ -0,0 +1,157 @@
+// util/utf8.cpp -- Decoding and measuring UTF-8 text, so that accented names, map glyphs and wide characters take up the right number of columns when
+// text is word-wrapped and lined up on the console.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "util/scan.hpp"
+#include "util/utf8.hpp"
+
+using std::string_view;
+
+namespace westgate::utf8 {
+
+namespace {
+
+// A range of codepoints, inclusive at both ends.
+struct Range {
+    char32_t    first;  // The first codepoint in the range.
+    char32_t    last;   // The last codepoint in the range.
+};
+
+// Codepoints which take up no space of their own: combining marks, which sit on top of the character before them, along with joiners, variation selectors,
+// direction marks and the like. Sorted, so they can be binary searched.
+constexpr Range zero_width_ranges[] = { { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 }, { 0x05C4, 0x05C5 },
+    { 0x05C7, 0x05C7 }, { 0x0610, 0x061A }, { 0x061C, 0x061C }, { 0x064B, 0x065F }, { 0x0670, 0x0670 }, { 0x06D6, 0x06DC }, { 0x06DF, 0x06E4 },
+    { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0711, 0x0711 }, { 0x0730, 0x074A }, { 0x07A6, 0x07B0 }, { 0x07EB, 0x07F3 }, { 0x0816, 0x082D },
+    { 0x0859, 0x085B }, { 0x08D3, 0x0902 }, { 0x093A, 0x093A }, { 0x093C, 0x093C }, { 0x0941, 0x0948 }, { 0x094D, 0x094D }, { 0x0951, 0x0957 },
+    { 0x0962, 0x0963 }, { 0x0981, 0x0981 }, { 0x09BC, 0x09BC }, { 0x09C1, 0x09C4 }, { 0x09CD, 0x09CD }, { 0x09E2, 0x09E3 }, { 0x0E31, 0x0E31 },
+    { 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E }, { 0x0EB1, 0x0EB1 }, { 0x0EB4, 0x0EBC }, { 0x0EC8, 0x0ECD }, { 0x0F18, 0x0F19 }, { 0x0F35, 0x0F35 },
+    { 0x0F37, 0x0F37 }, { 0x0F39, 0x0F39 }, { 0x0F71, 0x0F7E }, { 0x0F80, 0x0F84 }, { 0x0F86, 0x0F87 }, { 0x102D, 0x1030 }, { 0x1032, 0x1037 },
+    { 0x1039, 0x103A }, { 0x1160, 0x11FF }, { 0x135D, 0x135F }, { 0x1712, 0x1714 }, { 0x17B4, 0x17B5 }, { 0x17B7, 0x17BD }, { 0x17C6, 0x17C6 },
+    { 0x17C9, 0x17D3 }, { 0x180B, 0x180F }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F }, { 0x202A, 0x202E }, { 0x2060, 0x2064 },
+    { 0x20D0, 0x20F0 }, { 0x2CEF, 0x2CF1 }, { 0x2DE0, 0x2DFF }, { 0x302A, 0x302D }, { 0x3099, 0x309A }, { 0xA66F, 0xA672 }, { 0xA674, 0xA67D },
+    { 0xA69E, 0xA69F }, { 0xA6F0, 0xA6F1 }, { 0xA8E0, 0xA8F1 }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF }, { 0x1F3FB, 0x1F3FF },
+    { 0xE0000, 0xE0FFF } };
+
+// Codepoints which take up two columns: the East Asian wide and full-width characters, and emoji which are shown as pictures rather than text by default.
+// Sorted, so they can be binary searched.
+constexpr Range wide_ranges[] = { { 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x2329, 0x232A }, { 0x23E9, 0x23EC }, { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 },
+    { 0x25FD, 0x25FE }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 }, { 0x267F, 0x267F }, { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 }, { 0x26AA, 0x26AB },
+    { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 }, { 0x26CE, 0x26CE }, { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA }, { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 },
+    { 0x26FA, 0x26FA }, { 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B }, { 0x2728, 0x2728 }, { 0x274C, 0x274C }, { 0x274E, 0x274E },
+    { 0x2753, 0x2755 }, { 0x2757, 0x2757 }, { 0x2795, 0x2797 }, { 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF }, { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 },
+    { 0x2B55, 0x2B55 }, { 0x2E80, 0x303E }, { 0x3041, 0x33FF }, { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF }, { 0xA000, 0xA4CF }, { 0xA960, 0xA97F },
+    { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F }, { 0xFF00, 0xFF60 }, { 0xFFE0, 0xFFE6 }, { 0x16FE0, 0x16FE4 },
+    { 0x17000, 0x18CFF }, { 0x1B000, 0x1B2FF }, { 0x1F004, 0x1F004 }, { 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A }, { 0x1F200, 0x1F251 },
+    { 0x1F300, 0x1F64F }, { 0x1F680, 0x1F6FF }, { 0x1F7E0, 0x1F7EB }, { 0x1F900, 0x1F9FF }, { 0x1FA70, 0x1FAFF }, { 0x20000, 0x2FFFD }, { 0x30000, 0x3FFFD } };
+
+// Decodes the codepoint at pos and moves pos past it, or returns false and leaves pos alone if it isn't valid UTF-8. Overlong encodings, surrogates and
+// anything past U+10FFFF are all rejected.
+bool decode_valid(string_view str, size_t &pos, char32_t &cp)
+{
+    const unsigned char lead = static_cast<unsigned char>(str[pos]);
+    size_t length;
+    char32_t lowest;
+    if (lead < 0x80)
+    {
+        cp = lead;
+        pos++;
+        return true;
+    }
+    else if (lead >= 0xC2 && lead <= 0xDF) { length = 2; cp = lead & 0x1F; lowest = 0x80; }
+    else if (lead >= 0xE0 && lead <= 0xEF) { length = 3; cp = lead & 0x0F; lowest = 0x800; }
+    else if (lead >= 0xF0 && lead <= 0xF4) { length = 4; cp = lead & 0x07; lowest = 0x10000; }
+    else return false;
+
+    if (pos + length > str.size()) return false;
+    for (size_t i = 1; i < length; i++)
+    {
+        const unsigned char next = static_cast<unsigned char>(str[pos + i]);
+        if ((next & 0xC0) != 0x80) return false;
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    if (cp < lowest || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+    pos += length;
+    return true;
+}
+
+// Checks if a codepoint is in one of the ranges in a sorted table.
+template<size_t N> bool in_ranges(char32_t cp, const Range (&ranges)[N])
+{
+    if (cp < ranges[0].first || cp > ranges[N - 1].last) return false;
+    const Range* after = std::upper_bound(std::begin(ranges), std::end(ranges), cp, [](char32_t value, const Range &range) { return value < range.first; });
+    return (after != std::begin(ranges) && cp <= (after - 1)->last);
+}
+
+}   // anonymous namespace
+
+// Returns how many columns a codepoint takes up on the console: 0 for combining marks and the like, 2 for wide characters.
+unsigned int codepoint_width(char32_t cp)
+{
+    // Nothing below U+0300 is zero-width or wide, apart from the C1 control codes. ASCII control codes are counted as one column, as they always have been.
+    if (cp < 0x300) return (cp >= 0x80 && cp < 0xA0 ? 0 : 1);
+    if (in_ranges(cp, zero_width_ranges)) return 0;
+    if (in_ranges(cp, wide_ranges)) return 2;
+    return 1;
+}
+
+// Decodes the codepoint at pos, and moves pos past it. Invalid UTF-8 is decoded as REPLACEMENT_CHAR, one byte at a time.
+char32_t decode(string_view str, size_t &pos)
+{
+    char32_t cp;
+    if (decode_valid(str, pos, cp)) return cp;
+    pos++;
+    return REPLACEMENT_CHAR;
+}
+
+// As width(), but without the shortcut for short strings of plain ASCII.
+size_t measure(string_view str)
+{
+    // Most text is plain ASCII, which is one column per byte, so runs of ASCII are found with the scanning kernels and skipped over in one go.
+    size_t pos = scan::find_non_ascii(str);
+    if (pos == string_view::npos) return str.size();
+    size_t result = pos;
+    while (pos < str.size())
+    {
+        if (!(str[pos] & 0x80))
+        {
+            const size_t ascii_end = std::min(scan::find_non_ascii(str, pos), str.size());
+            result += ascii_end - pos;
+            pos = ascii_end;
+        }
+        else result += codepoint_width(decode(str, pos));
+    }
+    return result;
+}
+
+// Checks if a string is valid UTF-8.
+bool valid(string_view str)
+{
+    size_t pos = scan::find_non_ascii(str);
+    while (pos < str.size())
+    {
+        char32_t cp;
+        if (!decode_valid(str, pos, cp)) return false;
+        if (pos < str.size() && !(str[pos] & 0x80)) pos = scan::find_non_ascii(str, pos);  // Skip over any plain ASCII in one go.
+    }
+    return true;
+}
+
+}   // namespace westgate::utf8
@@ -0,0 +1,49 @@
+// util/utf8.hpp -- Decoding and measuring UTF-8 text, so that accented names, map glyphs and wide characters take up the right number of columns when
+// text is word-wrapped and lined up on the console.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // precompiled header
+
+namespace westgate::utf8 {
+
+constexpr char32_t  REPLACEMENT_CHAR = 0xFFFD;  // What invalid UTF-8 is decoded as.
+
+                // Returns how many columns a codepoint takes up on the console: 0 for combining marks and the like, 2 for wide characters.
+unsigned int    codepoint_width(char32_t cp);
+                // Decodes the codepoint at pos, and moves pos past it. Invalid UTF-8 is decoded as REPLACEMENT_CHAR, one byte at a time.
+char32_t        decode(std::string_view str, size_t &pos);
+size_t          measure(std::string_view str);  // As width(), but without the shortcut for short strings of plain ASCII.
+bool            valid(std::string_view str);    // Checks if a string is valid UTF-8.
+size_t          width(std::string_view str);    // Returns how many columns a string takes up on the console. Colour tags are not handled here.
+
+// Returns how many columns a string takes up on the console. Colour tags are not handled here. This is called for every word when wrapping text, so short
+// strings of plain ASCII (one column per byte) are spotted inline, rather than calling out to the scanning kernels.
+inline size_t width(std::string_view str)
+{
+    if (str.size() <= 16)
+    {
+        unsigned char high_bits = 0;
+        for (const char ch : str)
+            high_bits |= static_cast<unsigned char>(ch);
+        if (!(high_bits & 0x80)) return str.size();
+    }
+    return measure(str);
+}
+
+}   // namespace westgate::utf8
@@ -27,13 +27,13 @@ using std::vector;
 namespace westgate {
 
 // Blank constructor.
-YAML::YAML() : ref_(nullptr) { }
+YAML::YAML() : ref_(nullptr), tree_(nullptr) { }
 
 // Calls load_file() when constructing.
 YAML::YAML(const string_view filename, bool allow_backslash) { load_file(filename, allow_backslash); }
 
 // Creates a new YAML object from a parent tree.
-YAML::YAML(const ryml::Tree tree, ryml::ConstNodeRef new_ref) : ref_(new_ref), tree_(tree) { }
+YAML::YAML(std::shared_ptr<const ryml::Tree> tree, ryml::ConstNodeRef new_ref) : ref_(new_ref), tree_(tree) { }
 
 // Retrieves a value from a sequence, as a string.
 string YAML::get(size_t index) const
@@ -119,8 +119,9 @@ void YAML::load_file(const string_view filename, bool allow_backslash)
             }
         }
     }
-    tree_ = ryml::parse_in_arena(ryml::to_csubstr(file_string));
-    ref_ = tree_.rootref();
+    auto tree = std::make_shared<const ryml::Tree>(ryml::parse_in_arena(ryml::to_csubstr(file_string)));
+    ref_ = tree->crootref();
+    tree_ = std::move(tree);
 }
 
 // Returns the noderef for the loaded tree.
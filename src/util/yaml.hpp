@@ -20,6 +20,7 @@
 #include "core/pch.hpp" // precompiled header
 
 #include <map>
+#include <memory>
 
 #include "3rdparty/rapidyaml/rapidyaml-0.10.0.hpp"
 
@@ -42,13 +43,15 @@ public:
     std::string     val(const std::string_view key) const;      // Returns the value of a key, as a string.
 
 protected:
-                    YAML(const ryml::Tree tree, ryml::ConstNodeRef new_ref);    // Creates a new YAML object from a parent tree.
+                    // Creates a new YAML object from a parent tree.
+                    YAML(std::shared_ptr<const ryml::Tree> tree, ryml::ConstNodeRef new_ref);
 
 private:
     ryml::ConstNodeRef  noderef() const;    // Returns the noderef for the loaded tree.
 
     ryml::ConstNodeRef  ref_;   // The NodeRef for this part of the tree.
-    ryml::Tree          tree_;  // The parsed YAML data.
+    std::shared_ptr<const ryml::Tree>   tree_;  // The parsed YAML data. This is shared with any child objects, and never modified after parsing, so it's safe
+                                                // to read from multiple threads at once.
 };
 
 }   // namespace westgate
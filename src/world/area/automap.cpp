@@ -122,14 +122,16 @@ vector<string> Automap::generate_map(Room* start_room)
         }
     }
 
-    // Combine the strings in the vector into single lines, and strip out excess colour tags.
+    // Combine the strings in the vector into single lines, and strip out excess colour tags. Each line is padded out to MAP_WIDTH columns, measured rather than
+    // assumed, so that a map character taking up two columns (or none) doesn't push the room description out of line.
     vector<string> map_out(7);
     for (int y = 0; y < 7; y++)
     {
         map_out.at(y) = " ";
         for (int x = 0; x < 7; x++)
             map_out.at(y) += game_map.at(x + (y * 7));
-        map_out.at(y) = strx::flatten_tags(map_out.at(y) + "   " + "{0}");
+        const size_t line_width = strx::ansi_strlen(map_out.at(y));
+        map_out.at(y) = strx::flatten_tags(map_out.at(y) + string(line_width < MAP_WIDTH ? MAP_WIDTH - line_width : 0, ' ') + "{0}");
     }
 
     // Crop any excess space from the map.
@@ -30,6 +30,8 @@ class Room; // defined in world/area/room.hpp
 class Automap
 {
 public:
+    static constexpr size_t     MAP_WIDTH = 11; // The width of each line of the map, in columns, including the margins either side.
+
     std::vector<std::string>    generate_map(Room* start_room); // Generates a map centred on the specified coordinate.
 
 private:
@@ -100,6 +100,34 @@ LinkTag Link::parse_link_tag(const string_view tag)
     return result->second;
 }
 
+// Updates this Link from reloaded game data, keeping changes made during gameplay. Returns true if anything changed.
+bool Link::patch_from_gamedata(const Link &fresh)
+{
+    const bool tags_changed = tag(LinkTag::ChangedTags);
+    auto is_state_tag = [](LinkTag the_tag) { return the_tag == LinkTag::Open || the_tag == LinkTag::Locked || the_tag == LinkTag::AwareOfLock; };
+    auto is_delta_tag = [](LinkTag the_tag) { return the_tag == LinkTag::ChangedLink || the_tag == LinkTag::ChangedTags; };
+
+    // The state of a door (open, locked, etc.) is kept if it's been changed during gameplay. Everything else comes from the game data.
+    std::set<LinkTag> new_tags;
+    for (auto the_tag : tags_)
+        if (is_delta_tag(the_tag) || (tags_changed && is_state_tag(the_tag))) new_tags.insert(the_tag);
+    for (auto the_tag : fresh.tags_)
+        if (!is_delta_tag(the_tag) && !(tags_changed && is_state_tag(the_tag))) new_tags.insert(the_tag);
+
+    bool changed = false;
+    if (!tag(LinkTag::ChangedLink) && links_to_ != fresh.links_to_)
+    {
+        links_to_ = fresh.links_to_;
+        changed = true;
+    }
+    if (new_tags != tags_)
+    {
+        tags_ = std::move(new_tags);
+        changed = true;
+    }
+    return changed;
+}
+
 // Saves the delta changes to this Link (should only be called from its parent Room).
 void Link::save_delta(FileWriter* file)
 {
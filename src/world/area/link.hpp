@@ -70,6 +70,7 @@ public:
     const std::string   door_name() const;  // Returns the name of the door (door, gate, etc.) on this Link, if any.
     hash_wg     get() const;    // Gets the Room linked to by this Link.)
     void        load_delta(FileReader* file);   // Loads the delta changes to this Link (should only be called from its parent Room).
+    bool        patch_from_gamedata(const Link &fresh); // Updates this Link from reloaded game data, keeping changes made during gameplay.
     void        save_delta(FileWriter* file);   // Saves the delta changes to this Link (should only be called from its parent Room).
     void        set(hash_wg new_room, bool mark_delta = true);  // Sets this Link to point to a Room.
     void        set_tag(LinkTag the_tag, bool mark_delta = true);   // Sets a LinkTag on this Link.
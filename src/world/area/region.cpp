@@ -17,13 +17,18 @@
  * GNU Affero General Public License for more details.
  */
 
+#include <algorithm>
 #include <filesystem>
+#include <set>
 
 #include "core/core.hpp"
 #include "core/game.hpp"
 #include "parser/parser.hpp"
 #include "util/filex.hpp"
 #include "util/strx.hpp"
+#include "util/task-graph.hpp"
+#include "util/thread-pool.hpp"
+#include "util/utf8.hpp"
 #include "util/yaml.hpp"
 #include "world/area/automap.hpp"
 #include "world/area/region.hpp"
@@ -39,12 +44,35 @@ namespace fs = std::filesystem;
 namespace westgate {
 
 // Creates an empty Region.
-Region::Region() : id_(0), name_("Undefined Region") { }
+Region::Region() : climate_(0), has_weather_(false), id_(0), name_("Undefined Region"), weather_(TimeWeather::Weather::CLEAR) { }
 
 // Destructor, cleans up stored data.
 Region::~Region()
 { rooms_.clear(); }
 
+// Returns the ID of this Region's climate.
+uint8_t Region::climate() const { return climate_; }
+
+#ifdef WESTGATE_BUILD_DEBUG
+// When in debug mode, adds a Room which isn't in the game data, such as a test fixture.
+Room* Region::debug_add_room(std::unique_ptr<Room> room)
+{
+    if (!room) throw runtime_error("Attempt to add null room to region " + to_string(id_));
+    if (rooms_.count(room->id())) throw runtime_error("Attempt to add duplicate room " + room->id_str() + " to region " + to_string(id_));
+    Room* room_ptr = room.get();
+    world().add_room_to_region(room_ptr->id(), id_);
+    rooms_.insert({room_ptr->id(), std::move(room)});
+    return room_ptr;
+}
+
+// When in debug mode, removes a Room added with debug_add_room().
+void Region::debug_remove_room(hash_wg id)
+{
+    world().debug_remove_room_from_region(id);
+    rooms_.erase(id);
+}
+#endif
+
 // Attempts to find a room by its string ID.
 Room* Region::find_room(const string_view id) const
 { return find_room(strx::murmur3(id)); }
@@ -61,6 +89,12 @@ Room* Region::find_room(hash_wg id) const
     return result->second.get();
 }
 
+// Returns the filename of this Region's YAML game data.
+const string& Region::filename() const { return filename_; }
+
+// Checks if this Region has any weather of its own yet.
+bool Region::has_weather() const { return has_weather_; }
+
 // Retrieves this Region's unique ID.
 int Region::id() const { return id_; }
 
@@ -110,6 +144,9 @@ void Region::load_delta(int save_slot)
     if (file->read_string().compare("REGION_DELTA")) throw runtime_error("Invalid region deltas" + err_file);
     if (const int delta_id = file->read_data<int>();
         delta_id != id_) FileReader::standard_error("Mismatched region delta ID" + err_file, delta_id, id_);
+    has_weather_ = file->read_data<bool>();
+    weather_ = file->read_data<TimeWeather::Weather>();
+    rng_.load_data(file.get());
 
     // Load the Room deltas, if any.
     while(true)
@@ -134,9 +171,31 @@ void Region::load_delta(int save_slot)
 
 // Loads a Region from YAML game data.
 void Region::load_from_gamedata(const string_view filename, bool update_world)
+{
+    vector<std::unique_ptr<Room>> new_rooms = parse_gamedata(filename);
+    rng_.seed_stream(world().seed(), RandomStream::Stream::REGION, static_cast<uint32_t>(id_));
+    rooms_.reserve(rooms_.size() + new_rooms.size());
+    for (auto &room_ptr : new_rooms)
+    {
+#ifdef WESTGATE_BUILD_DEBUG
+        // In debug mode, if we're doing the initial new-game saved-data creation, check for name hash collisions.
+        if (!update_world) world().debug_mark_room(room_ptr->id_str());
+#endif
+
+        // If requested, update the lookup tables for Regions.
+        if (update_world) world().add_room_to_region(room_ptr->id(), id_);
+
+        // Add the Room to the Region.
+        rooms_.insert({room_ptr->id(), std::move(room_ptr)});
+    }
+}
+
+// Parses a Region's YAML game data, and builds all the Rooms within, in the same order as the file.
+vector<std::unique_ptr<Room>> Region::parse_gamedata(const string_view filename)
 {
     // Determine this region's ID from the filename.
     const string filename_str = string{filename};
+    filename_ = filename_str;
     auto dash_pos = filename.find_first_of('-');
     if (dash_pos == string::npos) throw runtime_error("Cannot determine region ID: " + filename_str);
     try { id_ = std::stoul(filename_str.substr(0, dash_pos)); }
@@ -160,74 +219,134 @@ void Region::load_from_gamedata(const string_view filename, bool update_world)
     if (region_version != REGION_YAML_VERSION) FileReader::standard_error("Invalid region version", region_version, REGION_YAML_VERSION, {filename_str});
     if (!region_id.key_exists("name")) throw runtime_error(filename_str + ": Missing region name in identifier data!");
     name_ = region_id.val("name");
+    climate_ = world().time_weather().climate_id(region_id.key_exists("climate") ? region_id.val("climate") : "");
+
+    // Get all the keys in this region, skipping the region identifier section, as we did that already.
+    vector<string> room_keys = yaml.keys();
+    room_keys.erase(std::remove(room_keys.begin(), room_keys.end(), "REGION_IDENTIFIER"), room_keys.end());
+
+    // Build the Rooms in batches, each batch into its own buffer. Large regions spread the batches over the worker threads; small ones aren't worth the
+    // overhead, and are just built here in a single batch.
+    ThreadPool &pool = core().thread_pool();
+    const size_t batch_size = std::max<size_t>(ROOMS_PER_BATCH, (room_keys.size() + pool.threads() - 1) / pool.threads());
+    const size_t batch_count = (room_keys.size() + batch_size - 1) / batch_size;
+    vector<vector<std::unique_ptr<Room>>> batches(batch_count);
+    auto build_batch = [&](size_t batch)
+    {
+        const size_t first = batch * batch_size, last = std::min(first + batch_size, room_keys.size());
+        batches.at(batch).reserve(last - first);
+        for (size_t i = first; i < last; i++)
+            batches.at(batch).push_back(load_room_from_gamedata(yaml.get_child(room_keys.at(i)), room_keys.at(i), filename_str));
+    };
+    if (batch_count == 1) build_batch(0);
+    else if (batch_count > 1)
+    {
+        // Each batch stops at its first error, and the graph rethrows the error from the earliest batch, so we always report the first bad Room in the file.
+        TaskGraph room_tasks;
+        for (size_t i = 0; i < batch_count; i++)
+            room_tasks.add(filename_str + " batch " + to_string(i), [&build_batch, i] { build_batch(i); });
+        room_tasks.start(pool);
+        room_tasks.wait_all();
+    }
+
+    // Merge the batches together, keeping the same order as the file.
+    vector<std::unique_ptr<Room>> new_rooms;
+    new_rooms.reserve(room_keys.size());
+    for (auto &batch : batches)
+        for (auto &room_ptr : batch)
+            new_rooms.push_back(std::move(room_ptr));
+    return new_rooms;
+}
 
-    // Get all the keys in this region, and iterate over them one at a time.
-    const vector<string> region_keys = yaml.keys();
-    for (auto key : region_keys)
+// Reloads this Region's YAML game data, and patches the resident Rooms with any changes, without losing any changes made during gameplay.
+void Region::reload_from_gamedata()
+{
+    if (!filename_.size()) throw runtime_error("Attempt to reload region with no game data!");
+    vector<std::unique_ptr<Room>> new_rooms = parse_gamedata(filename_);
+    std::set<hash_wg> room_ids;
+    unsigned int patched = 0, added = 0;
+    for (auto &room_ptr : new_rooms)
     {
-        if (key == "REGION_IDENTIFIER") continue;   // Skip the region identifier section, we did that already.
+        room_ids.insert(room_ptr->id());
+        if (auto result = rooms_.find(room_ptr->id()); result != rooms_.end())
+        {
+            if (result->second->patch_from_gamedata(*room_ptr)) patched++;
+        }
+        else
+        {
+            world().add_room_to_region(room_ptr->id(), id_);
+            rooms_.insert({room_ptr->id(), std::move(room_ptr)});
+            added++;
+        }
+    }
 
-        const YAML room_yaml = yaml.get_child(key);
-        const string error_str = filename_str + " [" + key + "]: ";
-        auto room_ptr = std::make_unique<Room>(key);
+    // Rooms that have been removed from the game data are left alone, as there may be Entities (including the player) inside them.
+    for (auto &room : rooms_)
+        if (!room_ids.count(room.first)) core().nonfatal(filename_ + " [" + room.second->id_str() + "]: Room missing from game data, cannot remove it while "
+            "the game is running.", Core::CORE_WARN);
+    core().log("Reloaded " + filename_ + ": " + to_string(patched) + " rooms updated, " + to_string(added) + " added.");
+}
 
-        if (!room_yaml.key_exists("name")) throw runtime_error(error_str + "Missing name data.");
-        if (!room_yaml.get_child("name").is_seq()) throw runtime_error(error_str + "Room name not correctly set (expected sequence).");
-        const vector<string> name_vec = room_yaml.get_seq("name");
-        if (name_vec.size() != 2) FileReader::standard_error("Name data sequence length incorrect", 2, name_vec.size(), {key});
-        room_ptr->set_name(name_vec[0], name_vec[1]);
+// Builds a single Room from YAML game data. This doesn't touch the Region or World, so it's safe to call from a worker thread.
+std::unique_ptr<Room> Region::load_room_from_gamedata(const YAML &room_yaml, const string &key, const string &filename)
+{
+    const string error_str = filename + " [" + key + "]: ";
+    auto room_ptr = std::make_unique<Room>(key);
 
-        if (!room_yaml.key_exists("desc")) throw runtime_error(error_str + "Missing room description.");
-        room_ptr->set_desc(room_yaml.val("desc"), false);
+    if (!room_yaml.key_exists("name")) throw runtime_error(error_str + "Missing name data.");
+    if (!room_yaml.get_child("name").is_seq()) throw runtime_error(error_str + "Room name not correctly set (expected sequence).");
+    const vector<string> name_vec = room_yaml.get_seq("name");
+    if (name_vec.size() != 2) FileReader::standard_error("Name data sequence length incorrect", 2, name_vec.size(), {key});
+    room_ptr->set_name(name_vec[0], name_vec[1], false);
 
-#ifdef WESTGATE_BUILD_DEBUG
-        // In debug mode, if we're doing the initial new-game saved-data creation, check for name hash collisions.
-        if (!update_world) world().debug_mark_room(key);
-#endif
+    if (!room_yaml.key_exists("desc")) throw runtime_error(error_str + "Missing room description.");
+    room_ptr->set_desc(room_yaml.val("desc"), false);
+
+    if (!room_yaml.key_exists("map")) throw runtime_error(error_str + "Missing map character.");
+    room_ptr->set_map_char(room_yaml.val("map"), false);
 
-        if (!room_yaml.key_exists("map")) throw runtime_error(error_str + "Missing map character.");
-        room_ptr->set_map_char(room_yaml.val("map"), false);
+    // Text with broken UTF-8 in it can't be measured properly, and would throw the word-wrapping and automap out of line.
+    if (!utf8::valid(name_vec[0]) || !utf8::valid(name_vec[1]) || !utf8::valid(room_yaml.val("desc")) || !utf8::valid(room_yaml.val("map")))
+        throw runtime_error(error_str + "Invalid UTF-8 text.");
 
-        // If the Room has any exits, process them here.
-        if (room_yaml.key_exists("exits"))
+    // If the Room has any exits, process them here.
+    if (room_yaml.key_exists("exits"))
+    {
+        YAML exits_yaml = room_yaml.get_child("exits");
+        vector<string> room_exit_keys = exits_yaml.keys();
+        for (auto &exit_key : room_exit_keys)
         {
-            YAML exits_yaml = room_yaml.get_child("exits");
-            vector<string> room_exit_keys = exits_yaml.keys();
-            for (auto &exit_key : room_exit_keys)
+            YAML exit_yaml = exits_yaml.get_child(exit_key);
+            Direction dir = parser::parse_direction(strx::murmur3(exit_key));
+            if (exit_yaml.is_seq()) // For Links with LinkTags attached.
             {
-                YAML exit_yaml = exits_yaml.get_child(exit_key);
-                Direction dir = parser::parse_direction(strx::murmur3(exit_key));
-                if (exit_yaml.is_seq()) // For Links with LinkTags attached.
+                room_ptr->set_link(dir, strx::murmur3(exit_yaml.get(0)), false);
+                if (exit_yaml.size() > 1)
                 {
-                    room_ptr->set_link(dir, strx::murmur3(exit_yaml.get(0)), false);
-                    if (exit_yaml.size() > 1)
-                    {
-                        for (size_t i = 1; i < exit_yaml.size(); i++)
-                            room_ptr->set_link_tag(dir, Link::parse_link_tag(exit_yaml.get(i)), false);
-                    }
+                    for (size_t i = 1; i < exit_yaml.size(); i++)
+                        room_ptr->set_link_tag(dir, Link::parse_link_tag(exit_yaml.get(i)), false);
                 }
-                else room_ptr->set_link(dir, strx::murmur3(exits_yaml.val(exit_key)), false);
             }
+            else room_ptr->set_link(dir, strx::murmur3(exits_yaml.val(exit_key)), false);
         }
+    }
 
-        // If the Room has any tags, process them here.
-        if (room_yaml.key_exists("tags"))
+    // If the Room has any tags, process them here.
+    if (room_yaml.key_exists("tags"))
+    {
+        if (!room_yaml.get_child("tags").is_seq()) throw runtime_error(error_str + "Invalid tags section.");
+        for (auto &tag : room_yaml.get_seq("tags"))
         {
-            if (!room_yaml.get_child("tags").is_seq()) throw runtime_error(error_str + "Invalid tags section.");
-            for (auto &tag : room_yaml.get_seq("tags"))
-            {
-                room_ptr->set_tag(Room::parse_room_tag(tag), false);
-            }
+            room_ptr->set_tag(Room::parse_room_tag(tag), false);
         }
-
-        // If requested, update the lookup tables for Regions.
-        if (update_world) world().add_room_to_region(room_ptr->id(), id_);
-
-        // Add the Room to the Region.
-        rooms_.insert({room_ptr->id(), std::move(room_ptr)});
     }
+
+    return room_ptr;
 }
 
+// Returns this Region's own stream of random numbers.
+RandomStream& Region::rng() { return rng_; }
+
 // Saves only the changes to this Region in a save file.
 void Region::save_delta(int save_slot, bool no_changes)
 {
@@ -245,6 +364,9 @@ void Region::save_delta(int save_slot, bool no_changes)
     file->write_data<unsigned int>(REGION_SAVE_VERSION);
     file->write_string("REGION_DELTA");
     file->write_data<int>(id_);
+    file->write_data<bool>(has_weather_);
+    file->write_data<TimeWeather::Weather>(weather_);
+    rng_.save_data(file.get());
 
     if (!no_changes)
     {
@@ -258,4 +380,14 @@ void Region::save_delta(int save_slot, bool no_changes)
     file->write_footer();
 }
 
+// Sets the current weather in this Region.
+void Region::set_weather(TimeWeather::Weather weather)
+{
+    weather_ = weather;
+    has_weather_ = true;
+}
+
+// Returns the current weather in this Region.
+TimeWeather::Weather Region::weather() const { return weather_; }
+
 }   // namespace westgate
@@ -23,9 +23,12 @@
 #include <unordered_map>
 
 #include "world/area/room.hpp"
+#include "world/time/time-weather.hpp"
 
 namespace westgate {
 
+class YAML; // defined in util/yaml.hpp
+
 class Region
 {
 public:
@@ -34,22 +37,44 @@ public:
 
                 Region();                       // Creates an empty Region.
                 ~Region();                      // Destructor, cleans up stored data.
+    uint8_t     climate() const;                // Returns the ID of this Region's climate.
+#ifdef WESTGATE_BUILD_DEBUG
+    Room*       debug_add_room(std::unique_ptr<Room> room); // When in debug mode, adds a Room which isn't in the game data, such as a test fixture.
+    void        debug_remove_room(hash_wg id);  // When in debug mode, removes a Room added with debug_add_room().
+#endif
     Room*       find_room(const std::string_view id) const; // Attempts to find a room by its string ID.
     Room*       find_room(hash_wg id) const;    // Attempts to find a room by its hashed ID.
+    const std::string&  filename() const;       // Returns the filename of this Region's YAML game data.
+    bool        has_weather() const;            // Checks if this Region has any weather of its own yet.
     int         id() const;                     // Retrieves this Region's unique ID.
     void        load(int save_slot, int region_id); // Loads this Region's YAML data, then applies delta changes from saved game binary data.
     void        load_from_gamedata(const std::string_view filename, bool update_world = false); // Loads a Region from YAML game data.
+                // Reloads this Region's YAML game data, and patches the resident Rooms with any changes, without losing any changes made during gameplay.
+    void        reload_from_gamedata();
+    RandomStream&   rng();                      // Returns this Region's own stream of random numbers.
     void        save_delta(int save_slot, bool no_changes = false); // Saves only the changes to this Region in a save file.
+    void        set_weather(TimeWeather::Weather weather);  // Sets the current weather in this Region.
+    TimeWeather::Weather    weather() const;    // Returns the current weather in this Region.
 
 private:
-    void        load_delta(int save_slot);  // Loads delta changes from a saved game file.
-
-    static constexpr unsigned int   REGION_SAVE_VERSION =       4;  // The expected version for saving/loading binary game data.
+    static constexpr size_t         ROOMS_PER_BATCH =           64; // The minimum number of Rooms to build on each worker thread when loading a Region.
+    static constexpr unsigned int   REGION_SAVE_VERSION =       6;  // The expected version for saving/loading binary game data.
     static constexpr unsigned int   REGION_YAML_VERSION =       4;  // The expected version for region YAML data.
 
+                // Builds a single Room from YAML game data. This doesn't touch the Region or World, so it's safe to call from a worker thread.
+    static std::unique_ptr<Room>    load_room_from_gamedata(const YAML &room_yaml, const std::string &key, const std::string &filename);
+    void        load_delta(int save_slot);  // Loads delta changes from a saved game file.
+                // Parses a Region's YAML game data, and builds all the Rooms within, in the same order as the file.
+    std::vector<std::unique_ptr<Room>>  parse_gamedata(const std::string_view filename);
+
+    uint8_t     climate_;   // The ID of this Region's climate, which decides how its weather changes.
+    std::string filename_;  // The filename of this Region's YAML game data.
+    bool        has_weather_;   // Does this Region have any weather of its own yet?
     int         id_;    // The ID of the loaded region file.
     std::string name_;  // The name of this Region.
+    RandomStream    rng_;   // This Region's own stream of random numbers, seeded from the world seed and the Region's ID.
     std::unordered_map<hash_wg, std::unique_ptr<Room>> rooms_;  // All the Rooms stored within this Region.
+    TimeWeather::Weather    weather_;   // The current weather in this Region, if has_weather_ is set.
 };
 
 }   // namespace westgate
@@ -20,7 +20,9 @@
 #include "core/game.hpp"
 #include "core/terminal.hpp"
 #include "util/filex.hpp"
+#include "util/format.hpp"
 #include "util/strx.hpp"
+#include "util/styled-text.hpp"
 #include "world/area/automap.hpp"
 #include "world/area/region.hpp"
 #include "world/area/room.hpp"
@@ -65,8 +67,16 @@ const RoomTag Room::unfinished_directions_[20] = { RoomTag::UnfinishedNorth, Roo
     RoomTag::UnfinishedUp, RoomTag::UnfinishedDown, RoomTag::PermalockNorth, RoomTag::PermalockNortheast, RoomTag::PermalockEast, RoomTag::PermalockSoutheast,
     RoomTag::PermalockSouth, RoomTag::PermalockSouthwest, RoomTag::PermalockWest, RoomTag::PermalockNorthwest, RoomTag::PermalockUp, RoomTag::PermalockDown };
 
+// Starts at 1, so that a newly-created Room's Exposure is always out of date.
+std::atomic<unsigned int> Room::exposure_epoch_ = 1;
+
+// As with exposure_epoch_, this starts at 1 so that a newly-created Room never has any cached look() output.
+std::atomic<unsigned int> Room::render_epoch_ = 1;
+Room::RenderStats Room::render_stats_ = { 0, 0 };
+
 // Creates a blank Room with default values and no ID.
-Room::Room() : desc_("Missing room description."), links_{}, id_(0), map_char_("{M}?"), name_{"undefined", "undefined"} { }
+Room::Room() : desc_("Missing room description."), exposure_{}, exposure_epoch_cached_(0), links_{}, id_(0), map_char_("{M}?"), name_{"undefined", "undefined"},
+    render_key_{} { }
 
 // Creates a Room with a specified ID.
 Room::Room(const string_view new_id) : Room()
@@ -75,6 +85,11 @@ Room::Room(const string_view new_id) : Room()
     id_ = strx::murmur3(new_id);
 }
 
+// Checks if two RenderKeys are the same.
+bool Room::RenderKey::operator==(const RenderKey &other) const
+{ return epoch == other.epoch && conditions == other.conditions && weather == other.weather && width == other.width && automap == other.automap &&
+    output == other.output; }
+
 // Adds an Entity to this room directly. Use transfer() to move Entities between rooms.
 void Room::add_entity(unique_ptr<Entity> entity)
 {
@@ -83,7 +98,10 @@ void Room::add_entity(unique_ptr<Entity> entity)
 }
 
 // Checks if we can see the outside world from here.
-bool Room::can_see_outside() const
+bool Room::can_see_outside() const { return exposure().sees_outside; }
+
+// Checks if we can see the outside world from here, without using the cached Exposure.
+bool Room::check_see_outside() const
 {
     // If the Room isn't tagged as Indoors or Underground, then it's de facto outside, so we can see outside.
     if (!tag(RoomTag::Indoors) && !tag(RoomTag::Underground)) return true;
@@ -116,6 +134,7 @@ void Room::clear_link_tag(Direction dir, LinkTag tag, bool mark_delta)
 {
     const int array_pos = link_id(dir, "clear_link_tag", true);
     links_[array_pos]->clear_tag(tag, mark_delta);
+    invalidate_exposure();
     if (mark_delta) set_tag(RoomTag::ChangedExits);
 }
 
@@ -124,6 +143,7 @@ void Room::clear_link_tags(Direction dir, std::list<LinkTag> tags_list, bool mar
 {
     const int array_pos = link_id(dir, "clear_link_tags", true);
     links_[array_pos]->clear_tags(tags_list, mark_delta);
+    invalidate_exposure();
     if (mark_delta) set_tag(RoomTag::ChangedExits);
 }
 
@@ -132,6 +152,9 @@ void Room::clear_tag(RoomTag the_tag, bool mark_delta)
 {
     if (!(tags_.count(the_tag) > 0)) return;
     tags_.erase(the_tag);
+    if (const unsigned short tag_int = static_cast<unsigned short>(the_tag);
+        tag_int >= EXPOSURE_TAGS_MIN && tag_int <= EXPOSURE_TAGS_MAX) invalidate_exposure();
+    else invalidate_render();
     if (mark_delta) set_tag(RoomTag::ChangedTags, false);
 }
 
@@ -158,6 +181,25 @@ const string Room::door_name(Direction dir) const
     else return links_[array_pos]->door_name();
 }
 
+// Returns the details of this Room's surroundings, recalculating them if anything has changed.
+const Room::Exposure& Room::exposure() const
+{
+    // The epoch is read before recalculating, as checking neighbouring Rooms can load a Region, which would increment it again.
+    const unsigned int epoch = exposure_epoch_.load(std::memory_order_relaxed);
+    if (exposure_epoch_cached_ == epoch) return exposure_;
+    exposure_.city = tag(RoomTag::City);
+    exposure_.indoors = tag(RoomTag::Indoors) || tag(RoomTag::Underground);
+    if (tag(RoomTag::AlwaysWinter)) exposure_.season = static_cast<unsigned char>(TimeWeather::Season::WINTER);
+    else if (tag(RoomTag::AlwaysSpring)) exposure_.season = static_cast<unsigned char>(TimeWeather::Season::SPRING);
+    else if (tag(RoomTag::AlwaysSummer)) exposure_.season = static_cast<unsigned char>(TimeWeather::Season::SUMMER);
+    else if (tag(RoomTag::AlwaysAutumn)) exposure_.season = static_cast<unsigned char>(TimeWeather::Season::AUTUMN);
+    else exposure_.season = static_cast<unsigned char>(TimeWeather::Season::AUTO);
+    exposure_.sees_outside = check_see_outside();
+    exposure_.trees = tag(RoomTag::Trees);
+    exposure_epoch_cached_ = epoch;
+    return exposure_;
+}
+
 // Gets the Room linked in the specified direction, or nullptr if none is linked.
 Room* Room::get_link(Direction dir)
 {
@@ -181,6 +223,16 @@ hash_wg Room::id() const { return id_; }
 // Retrieves the string ID of this Room.
 const string& Room::id_str() const { return id_str_; }
 
+// Marks every Room's cached Exposure as out of date, when a RoomTag or Link has changed.
+void Room::invalidate_exposure()
+{
+    exposure_epoch_.fetch_add(1, std::memory_order_relaxed);
+    invalidate_render();
+}
+
+// Marks every Room's cached look() output as out of date, when anything it shows has changed.
+void Room::invalidate_render() { render_epoch_.fetch_add(1, std::memory_order_relaxed); }
+
 // Checks if this Room has an unfinished link in a specified direction.
 bool Room::is_unfinished(Direction dir, bool permalock) const
 {
@@ -228,6 +280,7 @@ void Room::load_delta(FileReader* file)
             {
                 // Clear all existing tags, and load the full set of tags in from the save file.
                 tags_.clear();
+                invalidate_exposure();
                 size_wg tag_count = file->read_data<size_wg>();
                 for (size_wg i = 0; i < tag_count; i++)
                     set_tag(file->read_data<RoomTag>(), false);
@@ -237,12 +290,14 @@ void Room::load_delta(FileReader* file)
             case ROOM_DELTA_DESC:
             {
                 // Update the room description.
-                desc_ = file->read_string();
+                desc_ = TextTemplate{file->read_string()};
+                invalidate_render();
                 break;
             }
 
             case ROOM_DELTA_LINKS:
             {
+                invalidate_exposure();
                 for (int i = 0; i < 10; i++)
                 {
                     const unsigned int link_delta_type = file->read_data<unsigned int>();
@@ -275,6 +330,7 @@ void Room::load_delta(FileReader* file)
                 // Replace the room name with the save file data.
                 name_[0] = file->read_string();
                 name_[1] = file->read_string();
+                invalidate_render();
                 break;
             }
 
@@ -282,6 +338,7 @@ void Room::load_delta(FileReader* file)
             {
                 // Replace the map character with the save file data.
                 map_char_ = file->read_string();
+                invalidate_render();
                 break;
             }
 
@@ -294,10 +351,13 @@ void Room::load_delta(FileReader* file)
 // Look around you. Just look around you.
 void Room::look()
 {
-    const bool automap_enabled = !player().player_tag(PlayerTag::AutomapOff);
+    // Scripts and bots reading the headless output have no use for the automap, and the text isn't word-wrapped for them.
+    const terminal::Output output_mode = terminal::output_mode();
+    const bool headless = (output_mode != terminal::Output::CONSOLE);
+    const bool automap_enabled = !headless && !player().player_tag(PlayerTag::AutomapOff);
     const unsigned int term_width = terminal::get_width();
-    const unsigned int minimap_width = (automap_enabled ? 11 : 0);
-    const unsigned int desc_width = term_width - minimap_width;
+    const unsigned int minimap_width = (automap_enabled ? Automap::MAP_WIDTH : 0);
+    const size_t desc_width = (headless ? SIZE_MAX : term_width - minimap_width);
 
     if (automap_enabled && !player().player_tag(PlayerTag::TutorialAutomap))
     {
@@ -306,61 +366,25 @@ void Room::look()
             "simply type: {C}automap off\n");
     }
 
-    string processed_desc = desc_;
-    TimeWeather::TimeOfDay tod = world().time_weather().time_of_day(false);
-    strx::process_conditional_tags(processed_desc, "daydawn", tod == TimeWeather::TimeOfDay::DAWN || tod == TimeWeather::TimeOfDay::DAY);
-    strx::process_conditional_tags(processed_desc, "nightdusk", tod == TimeWeather::TimeOfDay::NIGHT || tod == TimeWeather::TimeOfDay::DUSK);
-    vector<string> room_desc = strx::ansi_vector_split("  " + processed_desc, desc_width);
-    room_desc.insert(room_desc.begin(), "{C}" + name_[0]);
-
-    if (can_see_outside())
+    // The output only needs rendering again if something it depends on has changed since the last time.
+    TimeWeather &time_weather = world().time_weather();
+    const RenderKey key = { render_epoch_.load(std::memory_order_relaxed), time_weather.text_conditions(), time_weather.weather_desc_stamp(), term_width,
+        automap_enabled, output_mode };
+    if (render_lines_.size() && key == render_key_) render_stats_.hits++;
+    else
     {
-        vector<string> weather_desc = strx::ansi_vector_split("{K}  " + world().time_weather().weather_desc(), desc_width);
-        room_desc.insert(room_desc.end(), weather_desc.begin(), weather_desc.end());
-    }
-
-    vector<string> exits_list;
-    string exits_list_str;
-    for (int i = 0; i < 10; i++)
-    {
-        if (!links_[i]) continue;
-        const hash_wg exit = links_[i]->get();
-        string exit_name = "{C}" + direction_name(static_cast<Direction>(i + 1)) + "{c}";
-        const Room* target_room = world().find_room(exit);
-
-        vector<string> exit_tags;
-        if (target_room->tag(RoomTag::Explored)) exit_tags.push_back(target_room->short_name());
-        if (links_[i]->tag(LinkTag::Openable))
-        {
-            if (links_[i]->tag(LinkTag::Open)) exit_tags.push_back("open");
-            else if (links_[i]->tag(LinkTag::AwareOfLock)) exit_tags.push_back("locked");
-            else exit_tags.push_back("closed");
-        }
-
-        if (exit_tags.size()) exit_name += " (" + strx::comma_list(exit_tags) + ")";
-        exits_list.push_back(exit_name);
+        render_stats_.misses++;
+        render_lines_ = render(output_mode, automap_enabled, desc_width);
+        render_key_ = key;
     }
-    if (exits_list.size()) exits_list_str = string("  {c}There ") + (exits_list.size() > 1 ? "are " : "is ") + strx::number_to_text(exits_list.size()) +
-        " obvious exit" + (exits_list.size() > 1 ? "s" : "") + ": " + strx::comma_list(exits_list, strx::CL_MODE_USE_AND) + ".";
-    exits_list = strx::ansi_vector_split(exits_list_str, desc_width);
-    room_desc.insert(room_desc.end(), exits_list.begin(), exits_list.end());
 
-    // Generate the room map (if any), then combine the room map and room description together.
-    vector<string> room_map, combined_vec;
-    if (automap_enabled) room_map = world().automap().generate_map(this);
-    const bool desc_longer = room_desc.size() > room_map.size();
-    const size_t total_length = (desc_longer ? room_desc.size() : room_map.size());
-    const size_t map_start = (desc_longer ? (room_desc.size() / 2 - room_map.size() / 2) : 0);
-    combined_vec.reserve(total_length);
-    for (size_t i = 0; i < total_length; i++)
+    if (output_mode == terminal::Output::JSON)
     {
-        if (i >= map_start && (i - map_start < room_map.size())) combined_vec.push_back(room_map.at(i - map_start) +
-            (room_desc.size() > i ? room_desc.at(i) : ""));
-        else combined_vec.push_back((automap_enabled ? "           " : "") + room_desc.at(i));
+        terminal::print_json(render_lines_.at(0));
+        return;
     }
-
     print();
-    for (auto str : combined_vec)
+    for (auto &str : render_lines_)
         print(str);
 }
 
@@ -384,10 +408,154 @@ RoomTag Room::parse_room_tag(const string_view tag)
     return result->second;
 }
 
+// Updates this Room from reloaded game data, keeping changes made during gameplay. Returns true if anything changed.
+bool Room::patch_from_gamedata(const Room &fresh)
+{
+    bool changed = false;
+    if (!tag(RoomTag::ChangedName) && (name_[0] != fresh.name_[0] || name_[1] != fresh.name_[1]))
+    {
+        name_[0] = fresh.name_[0];
+        name_[1] = fresh.name_[1];
+        changed = true;
+    }
+    if (!tag(RoomTag::ChangedDesc) && desc_.source() != fresh.desc_.source())
+    {
+        desc_ = fresh.desc_;
+        changed = true;
+    }
+    if (!tag(RoomTag::ChangedMapChar) && map_char_ != fresh.map_char_)
+    {
+        map_char_ = fresh.map_char_;
+        changed = true;
+    }
+
+    // Tags set during gameplay (delta markers, explored, etc.) are kept, while the tags from the game data are replaced entirely. If the tags have been changed
+    // during gameplay, the whole set is saved as the delta, so it's kept as it is; replacing the game data tags would undo anything set or cleared among them.
+    if (!tag(RoomTag::ChangedTags))
+    {
+        std::set<RoomTag> new_tags;
+        for (auto the_tag : tags_)
+            if (static_cast<unsigned short>(the_tag) < GAMEDATA_TAGS_MIN) new_tags.insert(the_tag);
+        for (auto the_tag : fresh.tags_)
+            if (static_cast<unsigned short>(the_tag) >= GAMEDATA_TAGS_MIN) new_tags.insert(the_tag);
+        if (new_tags != tags_)
+        {
+            tags_ = std::move(new_tags);
+            changed = true;
+        }
+    }
+
+    // Links changed during gameplay are kept even if the game data no longer has them, and if the exits have been changed, a missing Link may have been
+    // removed on purpose, so the game data doesn't bring it back.
+    const bool exits_changed = tag(RoomTag::ChangedExits);
+    for (int i = 0; i < 10; i++)
+    {
+        if (!fresh.links_[i])
+        {
+            if (!links_[i] || links_[i]->changed()) continue;
+            links_[i].reset(nullptr);
+            changed = true;
+        }
+        else if (!links_[i])
+        {
+            if (exits_changed) continue;
+            links_[i] = std::make_unique<Link>(*fresh.links_[i]);
+            changed = true;
+        }
+        else if (links_[i]->patch_from_gamedata(*fresh.links_[i])) changed = true;
+    }
+    if (changed) invalidate_exposure();
+    return changed;
+}
+
 // Returns the ID of the Region this Room belongs to.
 int Room::region() const
 { return world().find_room_region(id_); }
 
+// Renders the output of look() as a list of lines to print, or a single JSON event in JSON mode.
+vector<string> Room::render(terminal::Output output_mode, bool automap_enabled, size_t desc_width)
+{
+    const string processed_desc = desc_.render(world().time_weather().text_conditions());
+    const string weather_desc = (can_see_outside() ? world().time_weather().weather_desc() : "");
+
+    vector<string> exits_list;
+    string exits_json;
+    for (int i = 0; i < 10; i++)
+    {
+        if (!links_[i]) continue;
+        const hash_wg exit = links_[i]->get();
+        const string &dir_name = direction_name(static_cast<Direction>(i + 1));
+        const Room* target_room = world().find_room(exit);
+        const bool explored = target_room->tag(RoomTag::Explored);
+        const char* door_state = nullptr;
+        if (links_[i]->tag(LinkTag::Openable))
+        {
+            if (links_[i]->tag(LinkTag::Open)) door_state = "open";
+            else if (links_[i]->tag(LinkTag::AwareOfLock)) door_state = "locked";
+            else door_state = "closed";
+        }
+
+        // Each exit is listed along with whatever is known about it, e.g. north (the kitchen, open).
+        if (explored && door_state) exits_list.push_back(Format{"{C}%s{c} (%s, %s)", dir_name, target_room->short_name(), door_state}.str());
+        else if (explored || door_state) exits_list.push_back(Format{"{C}%s{c} (%s)", dir_name,
+            (explored ? string_view{target_room->short_name()} : string_view{door_state})}.str());
+        else exits_list.push_back(Format{"{C}%s{c}", dir_name}.str());
+
+        if (exits_json.size()) exits_json += ',';
+        exits_json += Format{"{\"direction\":%s", strx::json_quote(dir_name)};
+        if (explored) exits_json += Format{",\"room\":%s", strx::json_quote(target_room->short_name())};
+        if (door_state) exits_json += Format{",\"door\":\"%s\"", door_state};
+        exits_json += '}';
+    }
+
+    // In JSON mode, the whole room is sent as a single event.
+    if (output_mode == terminal::Output::JSON)
+    {
+        string desc = processed_desc;
+        strx::find_and_replace(desc, " {nl}", "{nl}");
+        strx::find_and_replace(desc, "{nl}", "\n");
+        string json = Format{"{\"type\":\"room\",\"id\":%s,\"name\":%s,\"desc\":%s", strx::json_quote(id_str_), strx::json_quote(strx::ansi_strip(name_[0])),
+            strx::json_quote(strx::ansi_strip(desc))}.str();
+        if (weather_desc.size()) json += Format{",\"weather\":%s", strx::json_quote(strx::ansi_strip(weather_desc))};
+        json += Format{",\"exits\":[%s]}", exits_json};
+        return { json };
+    }
+
+    vector<string> room_desc = StyledText{Format{"  %s", processed_desc}}.wrap(desc_width);
+    room_desc.insert(room_desc.begin(), Format{"{C}%s", name_[0]}.str());
+    if (weather_desc.size())
+    {
+        vector<string> weather_lines = StyledText{Format{"{K}  %s", weather_desc}}.wrap(desc_width);
+        room_desc.insert(room_desc.end(), weather_lines.begin(), weather_lines.end());
+    }
+    if (exits_list.size())
+    {
+        const bool plural = (exits_list.size() > 1);
+        exits_list = StyledText{Format{"  {c}There %s %s obvious exit%s: %s.", (plural ? "are" : "is"), strx::number_to_text(exits_list.size()),
+            (plural ? "s" : ""), strx::comma_list(exits_list, strx::CL_MODE_USE_AND)}}.wrap(desc_width);
+    }
+    else exits_list = StyledText{""}.wrap(desc_width);
+    room_desc.insert(room_desc.end(), exits_list.begin(), exits_list.end());
+
+    // Generate the room map (if any), then combine the room map and room description together.
+    vector<string> room_map, combined_vec;
+    if (automap_enabled) room_map = world().automap().generate_map(this);
+    const bool desc_longer = room_desc.size() > room_map.size();
+    const size_t total_length = (desc_longer ? room_desc.size() : room_map.size());
+    const size_t map_start = (desc_longer ? (room_desc.size() / 2 - room_map.size() / 2) : 0);
+    combined_vec.reserve(total_length);
+    for (size_t i = 0; i < total_length; i++)
+    {
+        if (i >= map_start && (i - map_start < room_map.size())) combined_vec.push_back(room_map.at(i - map_start) +
+            (room_desc.size() > i ? room_desc.at(i) : ""));
+        else combined_vec.push_back(string(automap_enabled ? Automap::MAP_WIDTH : 0, ' ') + room_desc.at(i));
+    }
+    return combined_vec;
+}
+
+// Returns the hit and miss counts for look()'s cached output.
+const Room::RenderStats& Room::render_stats() { return render_stats_; }
+
 // Reverses a Direction (e.g. north becomes south).
 Direction Room::reverse_direction(Direction dir)
 {
@@ -434,7 +602,7 @@ void Room::save_delta(FileWriter* file)
     if (desc_changed)
     {
         file->write_data<unsigned int>(ROOM_DELTA_DESC);
-        file->write_string(desc_);
+        file->write_string(desc_.source());
     }
 
     // If any of the exits have changed, add them here.
@@ -482,9 +650,10 @@ void Room::set_desc(const string_view new_desc, bool mark_delta)
     if (!new_desc.size())
     {
         core().nonfatal("Attempt to set blank description on room (" + id_str_ + ")", Core::CORE_ERROR);
-        desc_ = "Missing room description.";
+        desc_ = TextTemplate{"Missing room description."};
     }
-    else desc_ = new_desc;
+    else desc_ = TextTemplate{new_desc};
+    invalidate_render();
 }
 
 // Sets an exit link from this Room to another.
@@ -498,6 +667,7 @@ void Room::set_link(Direction dir, hash_wg new_exit, bool mark_delta)
         links_[array_pos] = std::move(new_link);
     }
     else links_[array_pos]->set(new_exit, mark_delta);
+    invalidate_exposure();
     if (mark_delta) set_tag(RoomTag::ChangedExits);
 }
 
@@ -506,6 +676,7 @@ void Room::set_link_tag(Direction dir, LinkTag tag, bool mark_delta)
 {
     int array_pos = link_id(dir, "set_link_tag", true);
     links_[array_pos]->set_tag(tag, mark_delta);
+    invalidate_exposure();
     if (mark_delta) set_tag(RoomTag::ChangedExits);
 }
 
@@ -514,6 +685,7 @@ void Room::set_link_tags(Direction dir, std::list<LinkTag> tags_list, bool mark_
 {
     int array_pos = link_id(dir, "set_link_tags", true);
     links_[array_pos]->set_tags(tags_list, mark_delta);
+    invalidate_exposure();
     if (mark_delta) set_tag(RoomTag::ChangedExits);
 }
 
@@ -522,6 +694,7 @@ void Room::set_map_char(const string_view new_char, bool mark_delta)
 {
     if (mark_delta) set_tag(RoomTag::ChangedMapChar);
     map_char_ = new_char;
+    invalidate_render();
 }
 
 // Sets the short name of this Room.
@@ -531,6 +704,7 @@ void Room::set_name(const string_view new_name, const string_view new_short_name
     if (mark_delta) set_tag(RoomTag::ChangedName);
     if (new_name.size()) name_[0] = new_name;
     if (new_short_name.size()) name_[1] = new_short_name;
+    invalidate_render();
 }
 
 // Sets a RoomTag on this Room.
@@ -538,6 +712,9 @@ void Room::set_tag(RoomTag the_tag, bool mark_delta)
 {
     if (tags_.count(the_tag) > 0) return;
     tags_.insert(the_tag);
+    if (const unsigned short tag_int = static_cast<unsigned short>(the_tag);
+        tag_int >= EXPOSURE_TAGS_MIN && tag_int <= EXPOSURE_TAGS_MAX) invalidate_exposure();
+    else invalidate_render();
     if (mark_delta) set_tag(RoomTag::ChangedTags, false);
 }
 
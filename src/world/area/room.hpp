@@ -19,10 +19,13 @@
 #pragma once
 #include "core/pch.hpp" // Precompiled header
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <set>
 
+#include "core/terminal.hpp"
+#include "util/text-template.hpp"
 #include "world/area/link.hpp"
 #include "world/entity/entity.hpp"
 
@@ -81,8 +84,26 @@ class Room {
 public:
     static constexpr unsigned int   ROOM_SAVE_VERSION = 10; // The expected version for saving/loading binary game data.
 
+    // Details of a Room's surroundings, as used by the time/weather system. These are cached, as they're checked whenever time passes.
+    struct Exposure {
+        bool            city;           // Is this Room part of a city?
+        bool            indoors;        // Is this Room indoors or underground?
+        unsigned char   season;         // The season this Room is locked to (as a TimeWeather::Season), or 0 (Season::AUTO) if it follows the calendar.
+        bool            sees_outside;   // Can the outside world be seen from here?
+        bool            trees;          // Are there trees nearby?
+    };
+
+    // How often look() has been able to reuse its cached output, rather than rendering the Room again.
+    struct RenderStats {
+        unsigned long long  hits;   // The number of times the cached output was reused.
+        unsigned long long  misses; // The number of times the Room had to be rendered.
+    };
+
     static const std::string&   direction_name(Direction dir);  // Gets the string name of a Direction enum.
     static RoomTag              parse_room_tag(const std::string_view tag); // Parses a string RoomTag name into a RoomTag enum.
+    static void                 invalidate_exposure();  // Marks every Room's cached Exposure as out of date, when a RoomTag or Link has changed.
+    static void                 invalidate_render();    // Marks every Room's cached look() output as out of date, when anything it shows has changed.
+    static const RenderStats&   render_stats();         // Returns the hit and miss counts for look()'s cached output.
     static Direction            reverse_direction(Direction dir);   // Reverses a Direction (e.g. north becomes south).
 
                 Room(); // Creates a blank Room with default values and no ID.
@@ -94,6 +115,7 @@ public:
     void        clear_tag(RoomTag the_tag, bool mark_delta = true); // Clears a RoomTag from this Room.
     void        clear_tags(std::list<RoomTag> tags_list, bool mark_delta = true);   // Clears multiple RoomTags at the same time.
     const std::string   door_name(Direction dir) const; // Returns the name of the door (door, gate, etc.) on the specified Link, if any.
+    const Exposure&     exposure() const;   // Returns the details of this Room's surroundings, recalculating them if anything has changed.
     Room*       get_link(Direction dir);    // Gets the Room linked in the specified direction, or nullptr if none is linked.
     bool        has_exit(Direction dir) const;  // Checks if an Exit exists in the specified Direction.
     hash_wg     id() const; // Retrieves the hashed ID of this Room.
@@ -104,6 +126,7 @@ public:
     void        look(); // Look around you. Just look around you.
     const std::string   map_char() const;   // Retrieves the map character for this Room.
     const std::string&  name() const;   // Retrieves the full name of this Room.
+    bool        patch_from_gamedata(const Room &fresh); // Updates this Room from reloaded game data, keeping changes made during gameplay.
     int         region() const; // Returns the ID of the Region this Room belongs to.
     void        save_delta(FileWriter* file);   // Saves only the changes to this Room in a save file. Should only be called by a parent Region.
     void        set_desc(const std::string_view new_desc, bool mark_delta = true);  // Sets the description of this Room.
@@ -131,24 +154,50 @@ private:
     static constexpr unsigned int   ROOM_DELTA_NAME =       5;  // The Room's name, if it's changed.
     static constexpr unsigned int   ROOM_DELTA_MAP_CHAR =   6;  // The Room's map character, if it's changed.
 
+    static constexpr unsigned short GAMEDATA_TAGS_MIN = 200;    // RoomTags from this value upwards are set by the game data, rather than during gameplay.
+    static constexpr unsigned short EXPOSURE_TAGS_MIN = 201;    // The range of RoomTags which can affect a Room's Exposure (Indoors through AlwaysAutumn).
+    static constexpr unsigned short EXPOSURE_TAGS_MAX = 209;
+
     static constexpr unsigned int   ROOM_DELTA_LINK_NONE =      100;    // Marks this Link as missing or removed.
     static constexpr unsigned int   ROOM_DELTA_LINK_UNCHANGED = 101;    // Marks this Link as existing but unchanged.
     static constexpr unsigned int   ROOM_DELTA_LINK_CHANGED =   201;    // Marks this Link as existing and modified.
 
+    // Everything the output of look() depends on, other than the Room itself. If this hasn't changed since the last look(), the output can be reused.
+    struct RenderKey {
+        unsigned int        epoch;      // The value of render_epoch_.
+        uint16_t            conditions; // The TextTemplate conditions which were true.
+        uint32_t            weather;    // The weather description's stamp, from TimeWeather::weather_desc_stamp().
+        unsigned int        width;      // The width of the terminal.
+        bool                automap;    // Was the automap shown?
+        terminal::Output    output;     // The terminal's output mode.
+
+        bool    operator==(const RenderKey &other) const;   // Checks if two RenderKeys are the same.
+    };
+
+    static std::atomic<unsigned int>    exposure_epoch_;    // Incremented whenever anything changes which could affect a Room's Exposure.
+    static std::atomic<unsigned int>    render_epoch_;      // Incremented whenever anything changes which could affect the output of look(), in any Room.
+    static RenderStats          render_stats_;              // The hit and miss counts for look()'s cached output.
     static const std::string    direction_names_[11];       // Lookup table to convert a Direction enum into a string name.
     static const Direction      reverse_direction_map_[11]; // Lookup table that inverts a Direction (e.g. east -> west).
     static const std::map<std::string, RoomTag> tag_map_;   // Used during loading YAML data, to convert RoomTag text names into RoomTag enums.
     static const RoomTag        unfinished_directions_[20]; // Lookup table for unfinished exit links.
 
+    bool    check_see_outside() const;  // Checks if we can see the outside world from here, without using the cached Exposure.
     // Turns a Direction into an int for array access, produces a standard error on invalid input.
-    int link_id(Direction dir, const std::string_view caller, bool fail_on_null = true) const;
+    int     link_id(Direction dir, const std::string_view caller, bool fail_on_null = true) const;
+            // Renders the output of look() as a list of lines to print, or a single JSON event in JSON mode.
+    std::vector<std::string>    render(terminal::Output output_mode, bool automap_enabled, size_t desc_width);
 
-    std::string desc_;          // The text description of this Room, as shown to the player.
+    TextTemplate    desc_;      // The text description of this Room, as shown to the player, compiled so its conditional tags don't need parsing each time.
+    mutable Exposure        exposure_;  // The cached details of this Room's surroundings.
+    mutable unsigned int    exposure_epoch_cached_; // The value of exposure_epoch_ when exposure_ was last calculated.
     std::unique_ptr<Link>   links_[10]; // Any and all Links leading out of this Room.
     hash_wg     id_;            // The Room's unique hashed ID.
     std::string id_str_;        // The Room's unique text ID.
     std::string map_char_;      // The character representing this Room on the minimap.
     std::string name_[2];       // The long and short name of this Room.
+    RenderKey   render_key_;    // The conditions render_lines_ were rendered under.
+    std::vector<std::string>    render_lines_;  // The output from the last look(), kept so it can be shown again without rendering it all over again.
     std::set<RoomTag> tags_;    // Any and all tags on this Room.
 };
 
@@ -150,13 +150,17 @@ const string Entity::name(unsigned int flags) const
     const bool possessive = ((flags & NAME_FLAG_POSSESSIVE) == NAME_FLAG_POSSESSIVE);
     const bool plural = ((flags & NAME_FLAG_PLURAL) == NAME_FLAG_PLURAL);
 
-    string ret = name_;
-    if (!ret.size())
+    if (!name_.size())
     {
         core().nonfatal("Missing mobile name!", Core::CORE_ERROR);
         return "";
     }
-    if (the && !tag(EntityTag::ProperNoun)) ret = "the " + name_;
+
+    // The name is built up in place, with room for anything that might be added to it, rather than out of temporary strings.
+    string ret;
+    ret.reserve(name_.size() + 6);
+    if (the && !tag(EntityTag::ProperNoun)) ret = "the ";
+    ret += name_;
     if (capitalize_first) ret[0] = std::toupper(ret[0]);
     if (possessive)
     {
@@ -0,0 +1,150 @@
+// world/time/calendar.cpp -- The game calendar. The date, moon phase and time of day are all worked out directly from a single count of seconds, so the
+// calendar can be moved forward by any amount of time in one step.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "world/time/calendar.hpp"
+
+using std::runtime_error;
+using std::to_string;
+using LightDark = westgate::TimeWeather::LightDark;
+using Season = westgate::TimeWeather::Season;
+using TimeOfDay = westgate::TimeWeather::TimeOfDay;
+
+namespace westgate::calendar {
+
+namespace {
+
+constexpr int   MINUTES_PER_DAY =   TimeWeather::DAY / TimeWeather::MINUTE;
+
+// Everything about the time of day changes on the minute, so it can all be looked up from the minute of the day.
+struct MinuteTable {
+    TimeOfDay   fine[MINUTES_PER_DAY];      // The fine time of day for each minute.
+    TimeOfDay   coarse[MINUTES_PER_DAY];    // The coarse time of day for each minute.
+    LightDark   light[MINUTES_PER_DAY];     // Whether it's light or dark at each minute.
+    short       next_change[MINUTES_PER_DAY];   // The minute of the next fine time of day change after each minute, which may be past midnight.
+};
+
+// Builds the minute table from the times (in minutes past midnight) at which each change happens.
+constexpr MinuteTable build_minute_table()
+{
+    constexpr struct { short minute; TimeOfDay tod; } fine_changes[] = { { 300, TimeOfDay::DAWN }, { 420, TimeOfDay::SUNRISE }, { 540, TimeOfDay::MORNING },
+        { 660, TimeOfDay::NOON }, { 1020, TimeOfDay::SUNSET }, { 1140, TimeOfDay::DUSK }, { 1260, TimeOfDay::NIGHT }, { 1380, TimeOfDay::MIDNIGHT } };
+    constexpr struct { short minute; TimeOfDay tod; } coarse_changes[] = { { 300, TimeOfDay::DAWN }, { 540, TimeOfDay::DAY }, { 1140, TimeOfDay::DUSK },
+        { 1380, TimeOfDay::NIGHT } };
+    constexpr struct { short minute; LightDark light; } light_changes[] = { { 277, LightDark::DARK }, { 420, LightDark::LIGHT }, { 1140, LightDark::DARK },
+        { 1285, LightDark::NIGHT } };
+
+    MinuteTable table{};
+    TimeOfDay fine = TimeOfDay::MIDNIGHT, coarse = TimeOfDay::NIGHT;
+    LightDark light = LightDark::NIGHT;
+    for (short minute = 0; minute < MINUTES_PER_DAY; minute++)
+    {
+        for (auto &change : fine_changes)
+            if (change.minute == minute) fine = change.tod;
+        for (auto &change : coarse_changes)
+            if (change.minute == minute) coarse = change.tod;
+        for (auto &change : light_changes)
+            if (change.minute == minute) light = change.light;
+        table.fine[minute] = fine;
+        table.coarse[minute] = coarse;
+        table.light[minute] = light;
+        table.next_change[minute] = fine_changes[0].minute + MINUTES_PER_DAY;
+        for (auto &change : fine_changes)
+        {
+            if (change.minute > minute)
+            {
+                table.next_change[minute] = change.minute;
+                break;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr MinuteTable   minute_table = build_minute_table();
+
+}   // anonymous namespace
+
+// Returns the number of times the date has changed since the calendar began.
+unsigned long long days(unsigned long long seconds)
+{
+    if (seconds < DAWN) throw runtime_error("Invalid calendar time: " + to_string(seconds));
+    return (seconds - DAWN) / TimeWeather::DAY;
+}
+
+// Returns the day of the month, from 1 to 28.
+int day_of_month(unsigned long long seconds) { return (day_of_year(seconds) - 1) % DAYS_PER_MONTH + 1; }
+
+// Returns the day of the week, from 1 (Sunsday) to 7 (Silversday).
+int day_of_week(unsigned long long seconds) { return (day_of_year(seconds) - 1) % DAYS_PER_WEEK + 1; }
+
+// Returns the day of the year, from 1 to 364.
+int day_of_year(unsigned long long seconds) { return static_cast<int>(days(seconds) % DAYS_PER_YEAR) + 1; }
+
+// Converts a day of the year and a time of day into a calendar time, in the first year.
+unsigned long long epoch(int day_of_year, int time)
+{
+    if (day_of_year < 1 || day_of_year > DAYS_PER_YEAR) throw runtime_error("Invalid day of year: " + to_string(day_of_year));
+    if (time < 0 || time >= TimeWeather::DAY) throw runtime_error("Invalid time of day: " + to_string(time));
+
+    // Before dawn, it's still the previous day, so the calendar time is in the following calendar day.
+    return static_cast<unsigned long long>(day_of_year - (time < DAWN ? 0 : 1)) * TimeWeather::DAY + time;
+}
+
+// Checks whether it's light or dark at the specified time.
+LightDark light_dark(unsigned long long seconds) { return minute_table.light[time(seconds) / TimeWeather::MINUTE]; }
+
+// Returns the month, from 0 (Harrowing) to 12 (Frost).
+int month(unsigned long long seconds) { return (day_of_year(seconds) - 1) / DAYS_PER_MONTH; }
+
+// Returns how many days into the lunar cycle the moon is, from 0 (new moon) to 28.
+int moon_day(unsigned long long seconds)
+{
+    // The lunar cycle is lined up so that there's a new moon on day 79, the first day of spring.
+    return static_cast<int>((days(seconds) + 9) % LUNAR_CYCLE_DAYS);
+}
+
+// Returns the season, by the calendar.
+Season season(unsigned long long seconds)
+{
+    const int day = day_of_year(seconds);
+    if (day < 79) return Season::WINTER;
+    else if (day < 172) return Season::SPRING;
+    else if (day <= 266) return Season::SUMMER;
+    else if (day <= 355) return Season::AUTUMN;
+    else return Season::WINTER;
+}
+
+// Returns how many seconds until the fine time of day next changes.
+int seconds_to_time_of_day_change(unsigned long long seconds)
+{
+    const int now = time(seconds);
+    return minute_table.next_change[now / TimeWeather::MINUTE] * TimeWeather::MINUTE - now;
+}
+
+// Returns the time of day, in seconds since midnight.
+int time(unsigned long long seconds) { return static_cast<int>(seconds % TimeWeather::DAY); }
+
+// Returns the time of day (morning, day, dusk, night).
+TimeOfDay time_of_day(unsigned long long seconds, bool fine)
+{
+    const int minute = time(seconds) / TimeWeather::MINUTE;
+    return (fine ? minute_table.fine[minute] : minute_table.coarse[minute]);
+}
+
+}   // namespace westgate::calendar
@@ -0,0 +1,48 @@
+// world/time/calendar.hpp -- The game calendar. The date, moon phase and time of day are all worked out directly from a single count of seconds, so the
+// calendar can be moved forward by any amount of time in one step.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+#include "world/time/time-weather.hpp"
+
+namespace westgate::calendar {
+
+// Calendar times are counted in seconds from midnight before the first dawn of the calendar. The date changes at dawn rather than midnight, so a calendar
+// time is never earlier than DAWN.
+constexpr int   DAWN =              420 * TimeWeather::MINUTE;  // The time of day when the date changes.
+constexpr int   DAYS_PER_MONTH =    28; // The number of days in each month.
+constexpr int   DAYS_PER_WEEK =     7;  // The number of days in each week.
+constexpr int   DAYS_PER_YEAR =     364;    // The number of days in each year.
+constexpr int   LUNAR_CYCLE_DAYS =  29; // The number of days in a lunar cycle.
+
+unsigned long long  days(unsigned long long seconds);   // Returns the number of times the date has changed since the calendar began.
+int         day_of_month(unsigned long long seconds);   // Returns the day of the month, from 1 to 28.
+int         day_of_week(unsigned long long seconds);    // Returns the day of the week, from 1 (Sunsday) to 7 (Silversday).
+int         day_of_year(unsigned long long seconds);    // Returns the day of the year, from 1 to 364.
+unsigned long long  epoch(int day_of_year, int time);   // Converts a day of the year and a time of day into a calendar time, in the first year.
+TimeWeather::LightDark  light_dark(unsigned long long seconds); // Checks whether it's light or dark at the specified time.
+int         month(unsigned long long seconds);          // Returns the month, from 0 (Harrowing) to 12 (Frost).
+int         moon_day(unsigned long long seconds);       // Returns how many days into the lunar cycle the moon is, from 0 (new moon) to 28.
+TimeWeather::Season season(unsigned long long seconds); // Returns the season, by the calendar.
+int         seconds_to_time_of_day_change(unsigned long long seconds);  // Returns how many seconds until the fine time of day next changes.
+int         time(unsigned long long seconds);           // Returns the time of day, in seconds since midnight.
+TimeWeather::TimeOfDay  time_of_day(unsigned long long seconds, bool fine); // Returns the time of day (morning, day, dusk, night).
+
+}   // namespace westgate::calendar
@@ -0,0 +1,295 @@
+// world/time/scheduler.cpp -- A hierarchical timing wheel, which runs events when they become due in game time.
+// Events are placed on one of several wheels, depending on how far ahead they are due. The bottom wheel has a slot for each second, and each wheel above it has
+// slots which cover a whole turn of the wheel below. When time reaches the start of a higher slot, its events cascade down into the finer wheels, so scheduling
+// and cancelling events are constant-time, and only events which are actually due ever need to be looked at.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#include "util/bits.hpp"
+#include "util/filex.hpp"
+#include "world/time/scheduler.hpp"
+
+using std::runtime_error;
+using std::to_string;
+
+namespace westgate {
+
+// Constructor, creates an empty scheduler starting at time zero.
+Scheduler::Scheduler() { clear(); }
+
+// Advances the scheduler to the specified time, running any events that have become due.
+void Scheduler::advance(unsigned long long now)
+{
+    while (now_ < now)
+    {
+        // Jump straight to the next time anything needs doing, rather than stepping through every second.
+        const unsigned long long wakeup = next_wakeup();
+        if (wakeup > now)
+        {
+            now_ = now;
+            return;
+        }
+        now_ = wakeup;
+
+        // Cascade any events from the higher wheels whose slots start now. The highest wheels go first, as they may cascade into slots below which also start
+        // now.
+        if (!(now_ & ((1ULL << WHEEL_BITS) - 1))) cascade(OVERFLOW_LIST);
+        for (int level = LEVELS - 1; level > 0; level--)
+        {
+            const int shift = level * SLOT_BITS;
+            if (!(now_ & ((1ULL << shift) - 1))) cascade(static_cast<uint16_t>(level * SLOTS + ((now_ >> shift) & (SLOTS - 1))));
+        }
+
+        // Run everything that's due now. Events are removed one at a time, as the handlers are free to schedule or cancel other events.
+        const uint16_t list = static_cast<uint16_t>(now_ & (SLOTS - 1));
+        while (heads_[list] != NONE)
+        {
+            const uint32_t index = pop(list);
+            const Event event = nodes_[index].event;
+            nodes_[index].list = UNUSED;
+            nodes_[index].generation++;
+            free_.push_back(index);
+            size_--;
+
+            const auto &handler = handlers_[static_cast<int>(event.type)];
+            if (!handler) throw runtime_error("No handler for scheduled event type " + to_string(static_cast<int>(event.type)));
+            handler(event);
+        }
+    }
+}
+
+// Cancels a scheduled event. Returns false if it had already happened, or been cancelled.
+bool Scheduler::cancel(EventID id)
+{
+    if (id == NO_EVENT) return false;
+    const uint32_t index = static_cast<uint32_t>(id & UINT32_MAX) - 1;
+    if (index >= nodes_.size()) return false;
+    Node &node = nodes_[index];
+    if (node.list == UNUSED || node.event.id != id) return false;
+    unlink(index);
+    node.list = UNUSED;
+    node.generation++;
+    free_.push_back(index);
+    size_--;
+    return true;
+}
+
+// Empties a list, placing each of its events back into the wheels relative to the current time.
+void Scheduler::cascade(uint16_t list)
+{
+    // The list is detached first, as events from the overflow list can end up right back where they started.
+    uint32_t index = heads_[list];
+    heads_[list] = tails_[list] = NONE;
+    if (list < OVERFLOW_LIST) occupied_[list / SLOTS] &= ~(1ULL << (list % SLOTS));
+    while (index != NONE)
+    {
+        const uint32_t next = nodes_[index].next;
+        place(index);
+        index = next;
+    }
+}
+
+// Removes all events, and resets the time to zero.
+void Scheduler::clear()
+{
+    for (int i = 0; i <= OVERFLOW_LIST; i++)
+        heads_[i] = tails_[i] = NONE;
+    for (int i = 0; i < LEVELS; i++)
+        occupied_[i] = 0;
+    free_.clear();
+    nodes_.clear();
+    now_ = 0;
+    size_ = 0;
+}
+
+// Loads the scheduled events from the specified save file.
+void Scheduler::load_data(FileReader* file)
+{
+    if (const unsigned int save_ver = file->read_data<unsigned int>();
+        save_ver != SCHEDULER_SAVE_VERSION) FileReader::standard_error("Incompatible scheduler data version", save_ver, SCHEDULER_SAVE_VERSION);
+    clear();
+    now_ = file->read_data<unsigned long long>();
+
+    // The generation of every node is kept, so that EventIDs held elsewhere remain valid.
+    nodes_.resize(file->read_data<uint32_t>());
+    for (auto &node : nodes_)
+    {
+        node.generation = file->read_data<uint32_t>();
+        node.list = UNUSED;
+    }
+
+    // Events are pushed back into exactly the same slots, in the same order, so they'll happen in the same order they would have before saving.
+    const uint32_t event_count = file->read_data<uint32_t>();
+    for (uint32_t i = 0; i < event_count; i++)
+    {
+        const uint16_t list = file->read_data<uint16_t>();
+        const uint32_t index = file->read_data<uint32_t>();
+        if (list > OVERFLOW_LIST || index >= nodes_.size() || nodes_[index].list != UNUSED) FileReader::standard_error("Invalid scheduled event data", index);
+        Event &event = nodes_[index].event;
+        event.id = (static_cast<uint64_t>(nodes_[index].generation) << 32) | (index + 1);
+        event.due = file->read_data<unsigned long long>();
+        event.type = file->read_data<EventType>();
+        event.target = file->read_data<hash_wg>();
+        event.param = file->read_data<int>();
+        if (event.type >= EventType::END) FileReader::standard_error("Invalid scheduled event type", static_cast<int64_t>(event.type));
+        push(list, index);
+        size_++;
+    }
+    for (uint32_t i = 0; i < nodes_.size(); i++)
+        if (nodes_[i].list == UNUSED) free_.push_back(i);
+}
+
+// Gets an unused node, reusing a free one if possible.
+uint32_t Scheduler::new_node()
+{
+    if (!free_.empty())
+    {
+        const uint32_t index = free_.back();
+        free_.pop_back();
+        return index;
+    }
+    if (nodes_.size() >= NONE - 1) throw runtime_error("Too many scheduled events!");
+    nodes_.push_back({{}, 1, UNUSED, NONE, NONE});
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+// Returns the next time that advance() will have anything to do, or ULLONG_MAX if nothing is scheduled.
+unsigned long long Scheduler::next_wakeup() const
+{
+    unsigned long long wakeup = ULLONG_MAX;
+    for (int level = 0; level < LEVELS; level++)
+    {
+        // Anything still on a wheel is always in a slot ahead of the current one, as the current slot has already been run or cascaded.
+        const int shift = level * SLOT_BITS;
+        const int current = static_cast<int>((now_ >> shift) & (SLOTS - 1));
+        const uint64_t ahead = (current == SLOTS - 1 ? 0 : occupied_[level] & (~0ULL << (current + 1)));
+        if (!ahead) continue;
+        const unsigned long long turn_start = (now_ >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+        const unsigned long long slot_start = turn_start + (static_cast<unsigned long long>(bits::lowest_bit(ahead)) << shift);
+        if (slot_start < wakeup) wakeup = slot_start;
+    }
+
+    // Events in the overflow list are looked at again each time the top wheel comes around.
+    if (heads_[OVERFLOW_LIST] != NONE)
+    {
+        const unsigned long long next_turn = ((now_ >> WHEEL_BITS) + 1) << WHEEL_BITS;
+        if (next_turn < wakeup) wakeup = next_turn;
+    }
+    return wakeup;
+}
+
+// Returns the time the scheduler has advanced to.
+unsigned long long Scheduler::now() const { return now_; }
+
+// Places a node into the correct wheel slot for its due time.
+void Scheduler::place(uint32_t index)
+{
+    // The wheel is chosen by the highest bit which differs between the due time and the current time, so each event sits in a slot which starts after now.
+    const unsigned long long due = nodes_[index].event.due;
+    const unsigned long long diff = due ^ now_;
+    if (diff >> WHEEL_BITS)
+    {
+        push(OVERFLOW_LIST, index);
+        return;
+    }
+    int level = 0;
+    while (level < LEVELS - 1 && (diff >> ((level + 1) * SLOT_BITS))) level++;
+    push(static_cast<uint16_t>(level * SLOTS + ((due >> (level * SLOT_BITS)) & (SLOTS - 1))), index);
+}
+
+// Removes the first node from a list, returning its index.
+uint32_t Scheduler::pop(uint16_t list)
+{
+    const uint32_t index = heads_[list];
+    unlink(index);
+    return index;
+}
+
+// Adds a node to the end of a list.
+void Scheduler::push(uint16_t list, uint32_t index)
+{
+    Node &node = nodes_[index];
+    node.list = list;
+    node.next = NONE;
+    node.prev = tails_[list];
+    if (tails_[list] == NONE) heads_[list] = index;
+    else nodes_[tails_[list]].next = index;
+    tails_[list] = index;
+    if (list < OVERFLOW_LIST) occupied_[list / SLOTS] |= 1ULL << (list % SLOTS);
+}
+
+// Saves the scheduled events to the specified save file.
+void Scheduler::save_data(FileWriter* file) const
+{
+    file->write_data<unsigned int>(SCHEDULER_SAVE_VERSION);
+    file->write_data<unsigned long long>(now_);
+    file->write_data<uint32_t>(static_cast<uint32_t>(nodes_.size()));
+    for (auto &node : nodes_)
+        file->write_data<uint32_t>(node.generation);
+    file->write_data<uint32_t>(static_cast<uint32_t>(size_));
+    for (uint16_t list = 0; list <= OVERFLOW_LIST; list++)
+    {
+        for (uint32_t index = heads_[list]; index != NONE; index = nodes_[index].next)
+        {
+            const Event &event = nodes_[index].event;
+            file->write_data<uint16_t>(list);
+            file->write_data<uint32_t>(index);
+            file->write_data<unsigned long long>(event.due);
+            file->write_data<EventType>(event.type);
+            file->write_data<hash_wg>(event.target);
+            file->write_data<int>(event.param);
+        }
+    }
+}
+
+// Schedules an event for the specified time. Events due in the past or present will happen on the next second.
+Scheduler::EventID Scheduler::schedule(unsigned long long due, EventType type, hash_wg target, int param)
+{
+    if (type >= EventType::END) throw runtime_error("Invalid scheduled event type " + to_string(static_cast<int>(type)));
+    if (due <= now_) due = now_ + 1;
+    const uint32_t index = new_node();
+    Node &node = nodes_[index];
+    node.event = {(static_cast<uint64_t>(node.generation) << 32) | (index + 1), due, type, target, param};
+    place(index);
+    size_++;
+    return node.event.id;
+}
+
+// Sets the function which runs events of the specified type.
+void Scheduler::set_handler(EventType type, std::function<void(const Event&)> handler)
+{
+    if (type >= EventType::END) throw runtime_error("Invalid scheduled event type " + to_string(static_cast<int>(type)));
+    handlers_[static_cast<int>(type)] = std::move(handler);
+}
+
+// Returns the number of events currently scheduled.
+size_t Scheduler::size() const { return size_; }
+
+// Removes a node from whichever list it's in.
+void Scheduler::unlink(uint32_t index)
+{
+    Node &node = nodes_[index];
+    const uint16_t list = node.list;
+    if (node.prev == NONE) heads_[list] = node.next;
+    else nodes_[node.prev].next = node.next;
+    if (node.next == NONE) tails_[list] = node.prev;
+    else nodes_[node.next].prev = node.prev;
+    node.next = node.prev = NONE;
+    if (list < OVERFLOW_LIST && heads_[list] == NONE) occupied_[list / SLOTS] &= ~(1ULL << (list % SLOTS));
+}
+
+}   // namespace westgate
@@ -0,0 +1,92 @@
+// world/time/scheduler.hpp -- A hierarchical timing wheel, which runs events when they become due in game time.
+
+/*
+ * SPDX-FileType: SOURCE
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Raine "Gravecat" Simmons <gc@gravecat.com>
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Affero General Public License for more details.
+ */
+
+#pragma once
+#include "core/pch.hpp" // Precompiled header
+
+#include <functional>
+
+namespace westgate {
+
+class FileReader;   // defined in util/filex.hpp
+class FileWriter;   // defined in util/filex.hpp
+
+class Scheduler {
+public:
+    // The types of event that can be scheduled. Events are saved by type rather than as callbacks, so new types should only ever be added to the end.
+    enum class EventType : unsigned char { WIND_CHANGE, DOOR_CLOSE, MOBILE_WAKE, ENCOUNTER, TIME_OF_DAY, END };
+
+    using EventID = uint64_t;   // Identifies a scheduled event, so it can be cancelled. Stays valid across saving and loading.
+    static constexpr EventID    NO_EVENT = 0;   // An EventID which never refers to a scheduled event.
+
+    struct Event {
+        EventID             id;     // The ID of this event.
+        unsigned long long  due;    // The time this event is due to happen.
+        EventType           type;   // The type of event.
+        hash_wg             target; // Whatever this event acts upon (a Room, a Mobile, etc.), if anything.
+        int                 param;  // An extra parameter, the meaning of which depends on the event type.
+    };
+
+                        Scheduler();    // Constructor, creates an empty scheduler starting at time zero.
+    void                advance(unsigned long long now);    // Advances the scheduler to the specified time, running any events that have become due.
+    bool                cancel(EventID id); // Cancels a scheduled event. Returns false if it had already happened, or been cancelled.
+    void                load_data(FileReader* file);    // Loads the scheduled events from the specified save file.
+    unsigned long long  next_wakeup() const;    // Returns the next time that advance() will have anything to do, or ULLONG_MAX if nothing is scheduled.
+    unsigned long long  now() const;    // Returns the time the scheduler has advanced to.
+    void                save_data(FileWriter* file) const;  // Saves the scheduled events to the specified save file.
+                        // Schedules an event for the specified time. Events due in the past or present will happen on the next second.
+    EventID             schedule(unsigned long long due, EventType type, hash_wg target = 0, int param = 0);
+    void                set_handler(EventType type, std::function<void(const Event&)> handler); // Sets the function which runs events of the specified type.
+    size_t              size() const;   // Returns the number of events currently scheduled.
+
+private:
+    static constexpr int        LEVELS =        4;  // The number of wheels in the hierarchy.
+    static constexpr int        SLOT_BITS =     6;  // Each wheel has 2^SLOT_BITS slots, and each slot covers 2^SLOT_BITS times as long as the wheel below.
+    static constexpr int        SLOTS =         1 << SLOT_BITS;
+    static constexpr int        WHEEL_BITS =    LEVELS * SLOT_BITS; // Events due further ahead than 2^WHEEL_BITS seconds wait in the overflow list.
+    static constexpr uint16_t   OVERFLOW_LIST = LEVELS * SLOTS;     // The list index used for the overflow list.
+    static constexpr uint32_t   NONE =          UINT32_MAX;         // Marks the end of a linked list.
+    static constexpr uint16_t   UNUSED =        UINT16_MAX;         // The list index used for nodes which aren't in use.
+    static constexpr unsigned int   SCHEDULER_SAVE_VERSION = 1; // The version of the scheduler data in the saved game file.
+
+    struct Node {
+        Event       event;      // The event itself.
+        uint32_t    generation; // Incremented each time this node is reused, so stale EventIDs can be detected.
+        uint16_t    list;       // Which slot (or the overflow list) this node is in, or UNUSED if it's not in use.
+        uint32_t    next, prev; // Links to the neighbouring nodes in the same list.
+    };
+
+    void        cascade(uint16_t list); // Empties a list, placing each of its events back into the wheels relative to the current time.
+    void        clear();                // Removes all events, and resets the time to zero.
+    uint32_t    new_node();             // Gets an unused node, reusing a free one if possible.
+    void        place(uint32_t index);  // Places a node into the correct wheel slot for its due time.
+    uint32_t    pop(uint16_t list);     // Removes the first node from a list, returning its index.
+    void        push(uint16_t list, uint32_t index);    // Adds a node to the end of a list.
+    void        unlink(uint32_t index); // Removes a node from whichever list it's in.
+
+    std::function<void(const Event&)>   handlers_[static_cast<int>(EventType::END)];    // The functions which run each type of event.
+    uint32_t                heads_[OVERFLOW_LIST + 1];  // The first node in each slot, plus the overflow list.
+    std::vector<Node>       nodes_;     // Storage for all the events, used or not.
+    unsigned long long      now_;       // The time the scheduler has advanced to.
+    uint64_t                occupied_[LEVELS];  // Bitmasks showing which slots on each wheel have anything in them.
+    std::vector<uint32_t>   free_;      // Nodes which are not currently in use.
+    size_t                  size_;      // The number of events currently scheduled.
+    uint32_t                tails_[OVERFLOW_LIST + 1];  // The last node in each slot, plus the overflow list.
+};
+
+}   // namespace westgate
@@ -22,14 +22,21 @@
 #include "core/core.hpp"
 #include "core/terminal.hpp"
 #include "util/filex.hpp"
+#include "util/format.hpp"
 #include "util/random.hpp"
+#include "util/static-data.hpp"
 #include "util/strx.hpp"
+#include "util/text-template.hpp"
 #include "util/yaml.hpp"
 #include "world/area/link.hpp"
+#include "world/area/region.hpp"
 #include "world/area/room.hpp"
 #include "world/entity/player.hpp"
+#include "world/time/calendar.hpp"
 #include "world/time/time-weather.hpp"
+#include "world/world.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 
@@ -43,23 +50,45 @@ namespace fs = std::filesystem;
 
 namespace westgate {
 
-// Sets up the time and weather system with default values, and loads its strings into memory.
-TimeWeather::TimeWeather() : time_passed_(0), time_passed_subsecond_(0)
-{
-    // Slightly randomize the starting time, but keep it within certain parameters (early- to mid-spring, between sunrise and noon).
-    day_ = rnd::get<int>(80, 130);
-    moon_ = (day_ - 79) % LUNAR_CYCLE_DAYS;
-    time_ = rnd::get<int>(420 * Time::MINUTE, 660 * Time::MINUTE);
-    wind_clockwise_ = rnd::get<bool>(0.5f);
-    wind_direction_ = static_cast<Direction>(rnd::get<int>(1, 8));
-    wind_next_change_ = rnd::get<int>(2 * HOUR, 4 * HOUR);
+// Tags which are replaced with different words in cities, in the form { tag, normal word, city word }.
+const string TimeWeather::locale_words_[7][3] = { { "$GROUND|STREET$", "ground", "street" }, { "$LAND|CITY$", "land", "city" },
+    { "$LAND|STREET$", "land", "street" }, { "$LAND|STREETS$", "land", "streets" }, { "$LANDSCAPE|CITY$", "landscape", "city" },
+    { "$LANDSCAPE|STREET$", "landscape", "street" }, { "$LANDSCAPE|STREETS$", "landscape", "streets" } };
 
-    // The starting weather is always either clear or fair.
-    if (rnd::get<bool>(0.5f)) weather_ = Weather::CLEAR;
-    else weather_ = Weather::FAIR;
+// Sets up the time and weather system with default values. A headless system has no Player or World to look at, and never prints anything.
+TimeWeather::TimeWeather(bool headless) : time_passed_(0), time_passed_subsecond_(0), weather_region_(-1), wind_event_(Scheduler::NO_EVENT),
+    time_of_day_event_(Scheduler::NO_EVENT), interrupted_(false), headless_(headless)
+{
+    scheduler_.set_handler(Scheduler::EventType::TIME_OF_DAY, [this](const Scheduler::Event &event) { change_time_of_day(event); });
+    scheduler_.set_handler(Scheduler::EventType::WIND_CHANGE, [this](const Scheduler::Event &event) { change_wind(event); });
+    reset(rnd::get<uint64_t>(0, UINT64_MAX));
+}
 
-    weather_change_map_.resize(9);
+// Loads the time and weather strings into memory. Safe to call from a worker thread.
+void TimeWeather::load_strings()
+{
+    std::map<string, std::array<string, 9>> climate_maps;
     const string filename = core().datafile("misc/weather.yml");
+#ifdef WESTGATE_STATIC_GAMEDATA
+    // If the data file hasn't been modified since the build, we can just use the copy compiled into the binary.
+    if (static_data::file_matches(filename, static_data::weather_yml_hash))
+    {
+        for (size_t i = 0; i < static_data::weather_strings_size; i++)
+        {
+            message_keys_.emplace_hint(message_keys_.end(), static_data::weather_strings[i].key, static_cast<short>(messages_.size()));
+            messages_.push_back(compile_message(static_data::weather_strings[i].val));
+        }
+        for (size_t i = 0; i < static_data::weather_maps_size; i++)
+        {
+            const string_view key = static_data::weather_maps[i].key;
+            climate_maps[string{key.substr(0, key.size() > 5 ? key.size() - 6 : 0)}].at(key.back() - '0') = static_data::weather_maps[i].val;
+        }
+        compile_message_tables();
+        compile_weather_tables(climate_maps);
+        return;
+    }
+    core().log("weather.yml has been modified, loading it from disk.");
+#endif
     if (!fs::is_regular_file(filename)) throw runtime_error("Could not load weather.yml!");
     YAML yaml(filename);
     if (!yaml.is_map()) throw runtime_error("weather.yml file is invalid!");
@@ -69,13 +98,189 @@ TimeWeather::TimeWeather() : time_passed_(0), time_passed_subsecond_(0)
         const string key = key_val.first;
         const string val = key_val.second;
 
-        if (key.size() == 5 && !key.substr(0,4).compare("WMAP"))
+        // Weather maps are either WMAP0 - WMAP8 for the default climate, or CLIMATE_WMAP0 - CLIMATE_WMAP8 for any other climate.
+        if (key.size() >= 5 && !key.compare(key.size() - 5, 4, "WMAP") && (key.size() == 5 || key.at(key.size() - 6) == '_'))
         {
-            const int map_id = key.at(4) - '0';
+            const int map_id = key.back() - '0';
             if (map_id < 0 || map_id > 8) throw runtime_error("Invalid weather map strings.");
-            weather_change_map_.at(map_id) = strx::decode_compressed_string(val);
+            climate_maps[key.substr(0, key.size() > 5 ? key.size() - 6 : 0)].at(map_id) = strx::decode_compressed_string(val);
+        }
+        else
+        {
+            message_keys_.insert({key, static_cast<short>(messages_.size())});
+            messages_.push_back(compile_message(val));
+        }
+    }
+    compile_message_tables();
+    compile_weather_tables(climate_maps);
+}
+
+// Moves on to the next time of day, changing the weather, and schedules the next change.
+void TimeWeather::change_time_of_day(const Scheduler::Event &event)
+{
+    time_of_day_event_ = scheduler_.schedule(event.due + calendar::seconds_to_time_of_day_change(epoch_ + event.due), Scheduler::EventType::TIME_OF_DAY);
+    const bool can_see_outside = !headless_ && player().parent_room()->can_see_outside();
+    const bool was_storm = (weather_ == Weather::BLIZZARD || weather_ == Weather::STORMY);
+    string weather_msg;
+    trigger_event(&weather_msg, !can_see_outside);
+    if (!can_see_outside) return;
+    print(Format{"{y}%s", string_view{weather_msg}.substr(1)});
+
+    // A storm breaking is something the player would want to stop and react to.
+    if (!was_storm && (weather_ == Weather::BLIZZARD || weather_ == Weather::STORMY)) interrupt();
+}
+
+// Changes the wind direction, and schedules the next change.
+void TimeWeather::change_wind(const Scheduler::Event &event)
+{
+    const bool storm = (weather_ == Weather::BLIZZARD || weather_ == Weather::STORMY);
+    if (storm) wind_next_change_ = event.due + rng_wind_.get<int>(30 * MINUTE, 60 * MINUTE);
+    else wind_next_change_ = event.due + rng_wind_.get<int>(2 * HOUR, 4 * HOUR);
+    wind_event_ = scheduler_.schedule(wind_next_change_ + 1, Scheduler::EventType::WIND_CHANGE);
+    if (rng_wind_.get<bool>(storm ? 0.5f : 0.1f))   // 10% chance (60% during storms) of the wind randomizing its direction and rotation
+    {
+        wind_clockwise_ = rng_wind_.get<bool>(0.5f);
+        wind_direction_ = static_cast<Direction>(rng_wind_.get<int>(1, 8));
+    }
+    // 35% chance (80% during storms) for the wind's rotation to switch.
+    else if (rng_wind_.get<bool>(storm ? 0.8f : 0.35f)) wind_clockwise_ = !wind_clockwise_;
+
+    // Rotate the wind, and apply the new value.
+    int wind_dir_int = static_cast<int>(wind_direction_);
+    wind_dir_int = ((wind_dir_int - 1 + (wind_clockwise_ ? 1 : -1) + 8) % 8) + 1;
+    wind_direction_ = static_cast<Direction>(wind_dir_int);
+}
+
+// Looks up a climate by name, or the default climate if the name is blank.
+uint8_t TimeWeather::climate_id(const string &name) const
+{
+    auto result = climate_ids_.find(name);
+    if (result == climate_ids_.end()) throw runtime_error("Unknown climate: " + name);
+    return result->second;
+}
+
+// Splits a message from weather.yml into segments.
+TimeWeather::Message TimeWeather::compile_message(const string_view str)
+{
+    Message message;
+    auto add_text = [&message](const string_view text, uint16_t conditions) {
+        if (text.empty()) return;
+        if (!message.empty() && message.back().type == MessageSegment::Type::TEXT && message.back().conditions == conditions) message.back().text += text;
+        else message.push_back({MessageSegment::Type::TEXT, conditions, 0, string{text}});
+    };
+
+    // Splits a section of text into plain text and the $TAGS$ which are filled in later. Unrecognized tags are left as they are.
+    auto add_section = [&message, &add_text](const string_view section, uint16_t conditions) {
+        size_t pos = 0;
+        while (pos < section.size())
+        {
+            const size_t tag_start = section.find('$', pos);
+            const size_t tag_end = (tag_start == string::npos ? string::npos : section.find('$', tag_start + 1));
+            if (tag_end == string::npos)
+            {
+                add_text(section.substr(pos), conditions);
+                return;
+            }
+            const string_view tag = section.substr(tag_start, tag_end - tag_start + 1);
+            add_text(section.substr(pos, tag_start - pos), conditions);
+            if (tag == "$WIND_DIR$")
+            {
+                message.push_back({MessageSegment::Type::WIND_DIR, conditions, 0, ""});
+                pos = tag_end + 1;
+                continue;
+            }
+            bool found = false;
+            for (unsigned char i = 0; i < 7; i++)
+            {
+                if (tag != locale_words_[i][0]) continue;
+                message.push_back({MessageSegment::Type::LOCALE_WORD, conditions, i, ""});
+                found = true;
+                break;
+            }
+            if (found) pos = tag_end + 1;
+            else
+            {
+                // The closing $ might be the start of a real tag, so only skip past the opening one.
+                add_text("$", conditions);
+                pos = tag_start + 1;
+            }
+        }
+    };
+
+    // Split the message into [outside:...] and [inside:...] sections, and the text in between which is always shown.
+    TextTemplate::split(str, add_section);
+    return message;
+}
+
+// Builds the lookup tables used to find messages for each season, time of day and weather type.
+void TimeWeather::compile_message_tables()
+{
+    static const string tod_names[9] = { "DAWN", "SUNRISE", "MORNING", "NOON", "SUNSET", "DUSK", "NIGHT", "MIDNIGHT", "DAY" };
+    auto find_message = [this](const string &key) -> short {
+        auto result = message_keys_.find(key);
+        return (result == message_keys_.end() ? -1 : result->second);
+    };
+
+    for (int tod = 0; tod < 9; tod++)
+    {
+        for (int weather = 0; weather < 9; weather++)
+        {
+            const string weather_name = weather_str(static_cast<Weather>(weather));
+            event_messages_[tod][weather] = find_message(tod_names[tod] + "_" + weather_name);
+            for (int season = 0; season < 4; season++)
+            {
+                const string prefix = season_str(static_cast<Season>(season + 1)) + "_" + tod_names[tod] + "_" + weather_name;
+                desc_messages_[season][tod][weather][0] = find_message(prefix);
+                desc_messages_[season][tod][weather][1] = find_message(prefix + "_TREES");
+            }
+        }
+    }
+}
+
+// Builds the weather transition tables for each climate from the weather maps in weather.yml.
+void TimeWeather::compile_weather_tables(const std::map<string, std::array<string, 9>> &climate_maps)
+{
+    // The default climate has a blank name, so it's always first in the map, and gets ID 0. Every other climate uses its maps, for any it doesn't specify.
+    auto default_maps = climate_maps.find("");
+    if (default_maps == climate_maps.end()) throw runtime_error("Missing weather map strings.");
+    for (auto &weather_map : default_maps->second)
+        if (weather_map.empty()) throw runtime_error("Missing weather map strings.");
+    if (climate_maps.size() > UINT8_MAX) throw runtime_error("Too many climates in weather.yml!");
+
+    // Each table is the weather map with each letter turned into the weather it stands for, so picking the next weather is just a matter of indexing it.
+    climate_ids_.clear();
+    weather_tables_.assign(climate_maps.size() * 9 * WEATHER_TABLE_SIZE, 0);
+    weather_table_sizes_.assign(climate_maps.size() * 9, 0);
+    for (auto &climate : climate_maps)
+    {
+        const uint8_t id = static_cast<uint8_t>(climate_ids_.size());
+        climate_ids_.insert({climate.first, id});
+        for (int weather = 0; weather < 9; weather++)
+        {
+            const string &weather_map = (climate.second.at(weather).empty() ? default_maps->second.at(weather) : climate.second.at(weather));
+            if (weather_map.size() >= WEATHER_TABLE_SIZE) throw runtime_error("Weather map too long: " + climate.first + (climate.first.size() ? "_" : "") +
+                "WMAP" + to_string(weather));
+            weather_table_sizes_.at(id * 9 + weather) = static_cast<uint8_t>(weather_map.size());
+            uint8_t* table = &weather_tables_.at((id * 9 + weather) * WEATHER_TABLE_SIZE);
+            for (size_t i = 0; i < weather_map.size(); i++)
+            {
+                Weather result;
+                switch (weather_map.at(i))
+                {
+                    case 'c': result = Weather::CLEAR; break;
+                    case 'f': result = Weather::FAIR; break;
+                    case 'r': result = Weather::RAIN; break;
+                    case 'F': result = Weather::FOG; break;
+                    case 'S': result = Weather::STORMY; break;
+                    case 'o': result = Weather::OVERCAST; break;
+                    case 'b': result = Weather::BLIZZARD; break;
+                    case 'l': result = Weather::LIGHTSNOW; break;
+                    case 'L': result = Weather::SLEET; break;
+                    default: result = static_cast<Weather>(weather); break;  // Anything else leaves the weather as it is.
+                }
+                table[i] = static_cast<uint8_t>(result);
+            }
         }
-        else tw_string_map_.insert({key, val});
     }
 }
 
@@ -83,46 +288,24 @@ TimeWeather::TimeWeather() : time_passed_(0), time_passed_subsecond_(0)
 TimeWeather::Season TimeWeather::current_season()
 {
     // Rooms can override the season with a fixed value, useful for deserts, icy mountains, etc.
-    Room* room = player().parent_room();
-    if (room->tag(RoomTag::AlwaysWinter)) return Season::WINTER;
-    if (room->tag(RoomTag::AlwaysSpring)) return Season::SPRING;
-    if (room->tag(RoomTag::AlwaysSummer)) return Season::SUMMER;
-    if (room->tag(RoomTag::AlwaysAutumn)) return Season::AUTUMN;
-
-    if (day_ > 364) throw runtime_error("Impossible day specified!");
-    if (day_ < 79) return Season::WINTER;
-    else if (day_ < 172) return Season::SPRING;
-    else if (day_ <= 266) return Season::SUMMER;
-    else if (day_ <= 355) return Season::AUTUMN;
-    else return Season::WINTER;
+    if (headless_) return calendar::season(calendar_time());
+    if (const Season room_season = static_cast<Season>(player().parent_room()->exposure().season);
+        room_season != Season::AUTO) return room_season;
+    return calendar::season(calendar_time());
 }
 
+// Returns the current time on the calendar.
+unsigned long long TimeWeather::calendar_time() const { return epoch_ + time_passed_; }
+
 // Returns the name of the current day of the week.
 string TimeWeather::day_name()
 {
-    unsigned int temp_day = day_;
-    while (temp_day > 7) temp_day -= 7;
-    switch (temp_day)
-    {
-        case 1: return "Sunsday";       // Sunday
-        case 2: return "Moonsday";      // Monday
-        case 3: return "Heavensday";    // Tuesday
-        case 4: return "Oathsday";      // Wednesday
-        case 5: return "Crownsday";     // Thursday
-        case 6: return "Swordsday";     // Friday
-        case 7: return "Silversday";    // Saturday
-    }
-    return "";  // Just to make the compiler shut up.
+    static const string day_names[calendar::DAYS_PER_WEEK] = { "Sunsday", "Moonsday", "Heavensday", "Oathsday", "Crownsday", "Swordsday", "Silversday" };
+    return day_names[calendar::day_of_week(calendar_time()) - 1];
 }
 
 // Returns the current day of the month.
-int TimeWeather::day_of_month()
-{
-    if (day_ <= 28) return day_;
-    unsigned int temp_day = day_;
-    while (temp_day > 28) temp_day -= 28;
-    return temp_day;
-}
+int TimeWeather::day_of_month() { return calendar::day_of_month(calendar_time()); }
 
 // Returns the day of the month in the form of a string like "1st" or "19th".
 string TimeWeather::day_of_month_string()
@@ -147,140 +330,98 @@ TimeWeather::Weather TimeWeather::fix_weather(TimeWeather::Weather weather, Time
     return weather;
 }
 
+// Stops any interruptible passing of time, such as a long action, e.g. when something happens the player should react to.
+void TimeWeather::interrupt() { interrupted_ = true; }
+
 // Checks whether it's light or dark right now.
-TimeWeather::LightDark TimeWeather::light_dark()
-{
-    if (time_ >= 1285 * Time::MINUTE) return LightDark::NIGHT;
-    else if (time_ >= 1140 * Time::MINUTE) return LightDark::DARK;
-    else if (time_ >= 420 * Time::MINUTE) return LightDark::LIGHT;
-    else if (time_ >= 277 * Time::MINUTE) return LightDark::DARK;
-    else return LightDark::NIGHT;
-}
+TimeWeather::LightDark TimeWeather::light_dark() { return calendar::light_dark(calendar_time()); }
 
 // Loads the time/weather data from the specified save file.
 void TimeWeather::load_data(FileReader* file)
 {
     if (const unsigned int tw_save_ver = file->read_data<unsigned int>();
         tw_save_ver != TIME_WEATHER_SAVE_VERSION) FileReader::standard_error("Incompatible time/weather data version", tw_save_ver, TIME_WEATHER_SAVE_VERSION);
-    day_ = file->read_data<int>();
-    moon_ = file->read_data<int>();
-    time_ = file->read_data<int>();
+    epoch_ = file->read_data<unsigned long long>();
     time_passed_ = file->read_data<unsigned long long>();
     time_passed_subsecond_ = file->read_data<float>();
     weather_ = file->read_data<Weather>();
+    weather_region_ = -1;
     wind_clockwise_ = file->read_data<bool>();
     wind_direction_ = file->read_data<Direction>();
     wind_next_change_ = file->read_data<unsigned long long>();
+    wind_event_ = file->read_data<Scheduler::EventID>();
+    time_of_day_event_ = file->read_data<Scheduler::EventID>();
+    rng_weather_.load_data(file);
+    rng_wind_.load_data(file);
+    scheduler_.load_data(file);
 }
 
 // Returns the name of the current month.
 string TimeWeather::month_name()
 {
-    if (day_ <= 28) return "Harrowing";             // January
-    else if (day_ <= 56) return "Shadows";          // February
-    else if (day_ <= 84) return "the Lord";         // March
-    else if (day_ <= 112) return "the Lady";        // April
-    else if (day_ <= 140) return "the Fall";        // May
-    else if (day_ <= 168) return "Fortune";         // June
-    else if (day_ <= 196) return "Fire";            // Sol
-    else if (day_ <= 224) return "Gold";            // July
-    else if (day_ <= 252) return "Seeking";         // August
-    else if (day_ <= 280) return "the Serpent";     // September
-    else if (day_ <= 308) return "Crimson";         // October
-    else if (day_ <= 336) return "King's Night";    // November
-    else return "Frost";                            // December
+    static const string month_names[calendar::DAYS_PER_YEAR / calendar::DAYS_PER_MONTH] = { "Harrowing", "Shadows", "the Lord", "the Lady", "the Fall",
+        "Fortune", "Fire", "Gold", "Seeking", "the Serpent", "Crimson", "King's Night", "Frost" };
+    return month_names[calendar::month(calendar_time())];
 }
 
 // Gets the current lunar phase.
 TimeWeather::LunarPhase TimeWeather::moon_phase()
 {
-    switch (moon_)
-    {
-        case 0: return LunarPhase::NEW;
-        case 1: case 2: case 3: case 4: case 5: case 6: return LunarPhase::WAXING_CRESCENT;
-        case 7: case 8: case 9: return LunarPhase::FIRST_QUARTER;
-        case 10: case 11: case 12: case 13: case 14: return LunarPhase::WAXING_GIBBOUS;
-        case 15: return LunarPhase::FULL;
-        case 16: case 17: case 18: case 19: case 20: return LunarPhase::WANING_GIBBOUS;
-        case 21: case 22: case 23: return LunarPhase::THIRD_QUARTER;
-        case 24: case 25: case 26: case 27: case 28: return LunarPhase::WANING_CRESCENT;
-        default: throw runtime_error("Impossible moon phase!");
-    }
+    static constexpr LunarPhase phases[calendar::LUNAR_CYCLE_DAYS] = { LunarPhase::NEW, LunarPhase::WAXING_CRESCENT, LunarPhase::WAXING_CRESCENT,
+        LunarPhase::WAXING_CRESCENT, LunarPhase::WAXING_CRESCENT, LunarPhase::WAXING_CRESCENT, LunarPhase::WAXING_CRESCENT, LunarPhase::FIRST_QUARTER,
+        LunarPhase::FIRST_QUARTER, LunarPhase::FIRST_QUARTER, LunarPhase::WAXING_GIBBOUS, LunarPhase::WAXING_GIBBOUS, LunarPhase::WAXING_GIBBOUS,
+        LunarPhase::WAXING_GIBBOUS, LunarPhase::WAXING_GIBBOUS, LunarPhase::FULL, LunarPhase::WANING_GIBBOUS, LunarPhase::WANING_GIBBOUS,
+        LunarPhase::WANING_GIBBOUS, LunarPhase::WANING_GIBBOUS, LunarPhase::WANING_GIBBOUS, LunarPhase::THIRD_QUARTER, LunarPhase::THIRD_QUARTER,
+        LunarPhase::THIRD_QUARTER, LunarPhase::WANING_CRESCENT, LunarPhase::WANING_CRESCENT, LunarPhase::WANING_CRESCENT, LunarPhase::WANING_CRESCENT,
+        LunarPhase::WANING_CRESCENT };
+    return phases[calendar::moon_day(calendar_time())];
 }
 
 // Causes time to pass.
 bool TimeWeather::pass_time(float seconds, bool allow_interrupt)
 {
-    // Add to the total time passed count.
+    // Work out how many whole seconds are to be added. Any interruption from before now is stale, as the player has already had a chance to react.
+    interrupted_ = false;
     time_passed_subsecond_ += seconds;
-    int seconds_to_add = 0;
-    if (time_passed_subsecond_ >= 1.0f)
-    {
-        seconds_to_add = floor(time_passed_subsecond_);
-        time_passed_ += seconds_to_add;
-        time_passed_subsecond_ -= seconds_to_add;
-    }
+    if (time_passed_subsecond_ < 1.0f) return true;
+    const int seconds_to_add = floor(time_passed_subsecond_);
+    time_passed_subsecond_ -= seconds_to_add;
+    const unsigned long long target = time_passed_ + seconds_to_add;
 
-    //int player_old_hp = World::player()->hp();
-    while (seconds_to_add)
+    sync_region_weather();
+    while (time_passed_ < target)
     {
-        seconds_to_add--;
+        // Most seconds are uneventful, so rather than stepping through them one at a time, skip straight to the second before the next time something can
+        // happen. The calendar is worked out from time_passed_, so this skips any amount of time in one go.
+        time_passed_ += std::min<unsigned long long>(quiet_seconds(time_passed_), target - time_passed_ - 1);
+        const unsigned long long now = time_passed_ + 1;
+
         //if (World::player()->game_over()) return false;
-        if (allow_interrupt)
-        {
-            //if (World::player()->hp() < player_old_hp) return false;
-            //player_old_hp = World::player()->hp();  // Because HP might go *up* in the meantime.
-        }
-        const bool can_see_outside = player().parent_room()->can_see_outside();
 
         // Check if it's due time for the wind to change direction. First, we'll shorten the duration if there's a storm ongoing.
         const bool storm = (weather_ == Weather::BLIZZARD || weather_ == Weather::STORMY);
-        if (storm && wind_next_change_ > time_passed_ - seconds_to_add)
+        if (storm && wind_next_change_ > now)
         {
-            const unsigned long long wind_change_time_left = wind_next_change_ - time_passed_ - seconds_to_add;
-            if (wind_change_time_left > HOUR) wind_next_change_ = time_passed_ - seconds_to_add + rnd::get<int>(30 * MINUTE, 60 * MINUTE);
-        }
-        // If it's due to change direction now, let's do it.
-        if (time_passed_ - seconds_to_add > wind_next_change_)
-        {
-            if (storm) wind_next_change_ = time_passed_ - seconds_to_add + rnd::get<int>(30 * MINUTE, 60 * MINUTE);
-            else wind_next_change_ = time_passed_ - seconds_to_add + rnd::get<int>(2 * HOUR, 4 * HOUR);
-            if (rnd::get<bool>(storm ? 0.5f : 0.1f))    // 10% chance (60% during storms) of the wind randomizing its direction and rotation
+            const unsigned long long wind_change_time_left = wind_next_change_ - now;
+            if (wind_change_time_left > HOUR)
             {
-                wind_clockwise_ = rnd::get<bool>(0.5f);
-                wind_direction_ = static_cast<Direction>(rnd::get<int>(1, 8));
+                wind_next_change_ = now + rng_wind_.get<int>(30 * MINUTE, 60 * MINUTE);
+                scheduler_.cancel(wind_event_);
+                wind_event_ = scheduler_.schedule(wind_next_change_ + 1, Scheduler::EventType::WIND_CHANGE);
             }
-            // 35% chance (80% during storms) for the wind's rotation to switch.
-            else if (rnd::get<bool>(storm ? 0.8f : 0.35f)) wind_clockwise_ = !wind_clockwise_;
-
-            // Rotate the wind, and apply the new value.
-            int wind_dir_int = static_cast<int>(wind_direction_);
-            wind_dir_int = ((wind_dir_int - 1 + (wind_clockwise_ ? 1 : -1) + 8) % 8) + 1;
-            wind_direction_ = static_cast<Direction>(wind_dir_int);
         }
 
-        TimeOfDay old_time_of_day = time_of_day(true);
-        int old_time = time_;
-        bool change_happened = false;
-        string weather_msg;
-        if (++time_ >= Time::DAY) time_ -= Time::DAY;
-        if (time_ >= 420 * Time::MINUTE && old_time < 420 * Time::MINUTE)   // Trigger moon-phase changing and day-of-year changing at dawn, not midnight.
-        {
-            if (++day_ > 364) day_ = 1;
-            if (++moon_ >= LUNAR_CYCLE_DAYS) moon_ = 0;
-            print("{Y}It is now " + day_name() + ", the " + day_of_month_string() + " day of " +  month_name() + ".");
-        }
-        old_time = time_;
-        if (time_of_day(true) != old_time_of_day)
-        {
-            weather_msg = "";
-            old_time_of_day = time_of_day(true);
-            trigger_event(&weather_msg, !can_see_outside);
-            change_happened = can_see_outside;
-        }
+        const unsigned long long old_days = calendar::days(calendar_time());
+        time_passed_ = now;
+
+        // The day of the year and the moon phase change at dawn, not midnight.
+        if (calendar::days(calendar_time()) != old_days && !headless_)
+            print(Format{"{Y}It is now %s, the %s day of %s.", day_name(), day_of_month_string(), month_name()});
 
-        if (change_happened) print("{y}" + weather_msg.substr(1));
+        // Run any scheduled events which are due now, including the wind changing direction, and the time of day moving on.
+        scheduler_.advance(now);
 
+        // Anything added here which needs to run every second will also need to be accounted for in quiet_seconds().
         //Encounters::tick(1);
 
         // Ticks all currently-active Mobiles.
@@ -288,6 +429,13 @@ bool TimeWeather::pass_time(float seconds, bool allow_interrupt)
         for (auto mob : *World::mobiles())
             mob->tick(1);
         */
+
+        // If anything that happened in this second needs the player's attention, interruptible time stops here. Anything left over never passes.
+        if (allow_interrupt && interrupted_)
+        {
+            interrupted_ = false;
+            return false;
+        }
     }
 
     return true;
@@ -295,7 +443,45 @@ bool TimeWeather::pass_time(float seconds, bool allow_interrupt)
 
 // Is the player near trees right now?
 bool TimeWeather::player_near_trees()
-{ return player().parent_room()->tag(RoomTag::Trees); }
+{ return player().parent_room()->exposure().trees; }
+
+// Returns how many of the seconds following the specified time will pass without anything happening, so pass_time() can skip over them in one go.
+unsigned long long TimeWeather::quiet_seconds(unsigned long long now)
+{
+    // If a storm is due to shorten the time until the next wind change, that has to happen right away.
+    const bool storm = (weather_ == Weather::BLIZZARD || weather_ == Weather::STORMY);
+    if (storm && wind_next_change_ > now + 1 && wind_next_change_ - (now + 1) > HOUR) return 0;
+
+    // Nothing can happen before the scheduler's next event, which includes the wind changing direction, and the time of day moving on (including dawn, when
+    // the date changes).
+    const unsigned long long wakeup = scheduler_.next_wakeup();
+    if (wakeup <= now + 1) return 0;
+    return wakeup - now - 1;
+}
+
+// Renders a compiled message for the player's current surroundings.
+string TimeWeather::render_message(short index, const string_view key)
+{
+    if (index < 0)
+    {
+        core().nonfatal("Unable to retrieve time/weather string: " + string{key}, Core::CORE_ERROR);
+        return "";
+    }
+    const Room::Exposure &exposure = player().parent_room()->exposure();
+    const uint16_t active = text_conditions();
+    string out;
+    for (auto &segment : messages_.at(index))
+    {
+        if (!TextTemplate::shown(segment.conditions, active)) continue;
+        switch (segment.type)
+        {
+            case MessageSegment::Type::TEXT: out += segment.text; break;
+            case MessageSegment::Type::LOCALE_WORD: out += locale_words_[segment.locale_word][exposure.city ? 2 : 1]; break;
+            case MessageSegment::Type::WIND_DIR: out += Room::direction_name(wind_direction_); break;
+        }
+    }
+    return out;
+}
 
 // Converts a season integer to a string.
 string TimeWeather::season_str(TimeWeather::Season season)
@@ -310,108 +496,152 @@ string TimeWeather::season_str(TimeWeather::Season season)
     }
 }
 
+// Picks new starting conditions for a new game, with the random number streams seeded from the specified world seed.
+void TimeWeather::reset(uint64_t world_seed)
+{
+    rng_weather_.seed_stream(world_seed, RandomStream::Stream::WEATHER);
+    rng_wind_.seed_stream(world_seed, RandomStream::Stream::WIND);
+
+    // Slightly randomize the starting time, but keep it within certain parameters (early- to mid-spring, between sunrise and noon).
+    const int start_day = rng_weather_.get<int>(80, 130);
+    epoch_ = calendar::epoch(start_day, rng_weather_.get<int>(420 * Time::MINUTE, 660 * Time::MINUTE));
+    wind_clockwise_ = rng_wind_.get<bool>(0.5f);
+    wind_direction_ = static_cast<Direction>(rng_wind_.get<int>(1, 8));
+    wind_next_change_ = time_passed_ + rng_wind_.get<int>(2 * HOUR, 4 * HOUR);
+    scheduler_.cancel(wind_event_);
+    wind_event_ = scheduler_.schedule(wind_next_change_ + 1, Scheduler::EventType::WIND_CHANGE);
+    scheduler_.cancel(time_of_day_event_);
+    time_of_day_event_ = scheduler_.schedule(time_passed_ + calendar::seconds_to_time_of_day_change(calendar_time()), Scheduler::EventType::TIME_OF_DAY);
+
+    // The starting weather is always either clear or fair.
+    if (rng_weather_.get<bool>(0.5f)) weather_ = Weather::CLEAR;
+    else weather_ = Weather::FAIR;
+}
+
 // Saves the time/weather data to the specified datafile.
 void TimeWeather::save_data(FileWriter* file)
 {
     file->write_data<unsigned int>(TIME_WEATHER_SAVE_VERSION);
-    file->write_data<int>(day_);
-    file->write_data<int>(moon_);
-    file->write_data<int>(time_);
+    file->write_data<unsigned long long>(epoch_);
     file->write_data<unsigned long long>(time_passed_);
     file->write_data<float>(time_passed_subsecond_);
     file->write_data<Weather>(weather_);
     file->write_data<bool>(wind_clockwise_);
     file->write_data<Direction>(wind_direction_);
     file->write_data<unsigned long long>(wind_next_change_);
+    file->write_data<Scheduler::EventID>(wind_event_);
+    file->write_data<Scheduler::EventID>(time_of_day_event_);
+    rng_weather_.save_data(file);
+    rng_wind_.save_data(file);
+    scheduler_.save_data(file);
 }
 
-// Retrieves a message directly from the string map, with tags processed.
-string TimeWeather::string_map(const string_view key)
+// Returns a reference to the game-time event scheduler.
+Scheduler& TimeWeather::scheduler() { return scheduler_; }
+
+// Advances the weather in every resident Region at once.
+void TimeWeather::step_region_weather()
 {
-    const string key_str = string{key};
-    const Room* player_room = player().parent_room();
-    const bool indoors = player_room->tag(RoomTag::Indoors) || player_room->tag(RoomTag::Underground);
-    const bool in_city = player_room->tag(RoomTag::City);
-    auto result = tw_string_map_.find(key_str);
-    if (result == tw_string_map_.end())
+    // Without a World, there's just the one weather, in the default climate.
+    if (headless_)
     {
-        core().nonfatal("Unable to retrieve time/weather string: " + key_str, Core::CORE_ERROR);
-        return "";
+        uint8_t climate = 0, weather = static_cast<uint8_t>(weather_);
+        const uint8_t roll = static_cast<uint8_t>(rng_weather_.get<int>(0, weather_table_sizes_[weather] - 1));
+        step_weather(&climate, &weather, &roll, 1);
+        weather_ = static_cast<Weather>(weather);
+        return;
     }
-    string out = result->second;
-    strx::process_conditional_tags(out, "outside", !indoors);
-    strx::process_conditional_tags(out, "inside", indoors);
-    if (in_city)
+
+    sync_region_weather();
+    const vector<Region*> regions = world().resident_regions();
+    const size_t count = regions.size();
+    vector<uint8_t> climates(count), weathers(count), rolls(count);
+
+    // Each Region rolls from its own random number stream, so its weather only depends on the world seed and its own history, not on which other Regions
+    // happen to be loaded. Regions which have never had any weather of their own start off with the weather the player is currently seeing.
+    for (size_t i = 0; i < count; i++)
     {
-        strx::find_and_replace(out, "$GROUND|STREET$", "street");
-        strx::find_and_replace(out, "$LAND|CITY$", "city");
-        strx::find_and_replace(out, "$LAND|STREET$", "street");
-        strx::find_and_replace(out, "$LAND|STREETS$", "streets");
-        strx::find_and_replace(out, "$LANDSCAPE|CITY$", "city");
-        strx::find_and_replace(out, "$LANDSCAPE|STREETS$", "streets");
+        if (!regions[i]->has_weather()) regions[i]->set_weather(weather_);
+        climates[i] = regions[i]->climate();
+        weathers[i] = static_cast<uint8_t>(regions[i]->weather());
+        rolls[i] = static_cast<uint8_t>(regions[i]->rng().get<int>(0, weather_table_sizes_[climates[i] * 9 + weathers[i]] - 1));
     }
-    else
+    step_weather(climates.data(), weathers.data(), rolls.data(), count);
+    for (size_t i = 0; i < count; i++)
     {
-        strx::find_and_replace(out, "$GROUND|STREET$", "ground");
-        strx::find_and_replace(out, "$LAND|CITY$", "land");
-        strx::find_and_replace(out, "$LAND|STREET$", "land");
-        strx::find_and_replace(out, "$LAND|STREETS$", "land");
-        strx::find_and_replace(out, "$LANDSCAPE|CITY$", "landscape");
-        strx::find_and_replace(out, "$LANDSCAPE|STREETS$", "landscape");
+        regions[i]->set_weather(static_cast<Weather>(weathers[i]));
+        if (regions[i]->id() == weather_region_) weather_ = static_cast<Weather>(weathers[i]);
     }
-    strx::find_and_replace(out, "$WIND_DIR$", Room::direction_name(wind_direction_));
-    return out;
 }
 
-// Returns the current time of day (morning, day, dusk, night)
-TimeWeather::TimeOfDay TimeWeather::time_of_day(bool fine)
+// Looks up the next weather for a batch of Regions, from their climates, current weather, and random rolls.
+void TimeWeather::step_weather(const uint8_t* climates, uint8_t* weathers, const uint8_t* rolls, size_t count) const
+{
+    // Each step is a single byte lookup into the outcome tables. There's no SIMD path here: gathering bytes from a table needs AVX2 gathers at the very least,
+    // and there are only ever a handful of resident Regions, each rolling from its own random number stream first, so the lookups are never the bottleneck.
+    const uint8_t* tables = weather_tables_.data();
+    for (size_t i = 0; i < count; i++)
+        weathers[i] = tables[(climates[i] * 9 + weathers[i]) * WEATHER_TABLE_SIZE + rolls[i]];
+}
+
+// Retrieves a message directly from the string map, with tags processed.
+string TimeWeather::string_map(const string_view key)
+{
+    auto result = message_keys_.find(string{key});
+    return render_message(result == message_keys_.end() ? -1 : result->second, key);
+}
+
+// Returns the TextTemplate conditions which are true right now, for the player's current surroundings.
+uint16_t TimeWeather::text_conditions()
 {
-    if (fine)
+    uint16_t conditions = TextTemplate::ALWAYS;
+    switch(time_of_day(false))
     {
-        if (time_ >= 1380 * Time::MINUTE) return TimeOfDay::MIDNIGHT;
-        else if (time_ >= 1260 * Time::MINUTE) return TimeOfDay::NIGHT;
-        else if (time_ >= 1140 * Time::MINUTE) return TimeOfDay::DUSK;
-        else if (time_ >= 1020 * Time::MINUTE) return TimeOfDay::SUNSET;
-        else if (time_ >= 660 * Time::MINUTE) return TimeOfDay::NOON;
-        else if (time_ >= 540 * Time::MINUTE) return TimeOfDay::MORNING;
-        else if (time_ >= 420 * Time::MINUTE) return TimeOfDay::SUNRISE;
-        else if (time_ >= 300 * Time::MINUTE) return TimeOfDay::DAWN;
-        return TimeOfDay::MIDNIGHT;
-    } else
+        case TimeOfDay::DAWN: conditions |= TextTemplate::DAWN; break;
+        case TimeOfDay::DUSK: conditions |= TextTemplate::DUSK; break;
+        case TimeOfDay::NIGHT: conditions |= TextTemplate::NIGHT; break;
+        default: conditions |= TextTemplate::DAY; break;
+    }
+    switch(current_season())
     {
-        if (time_ >= 1380 * Time::MINUTE) return TimeOfDay::NIGHT;
-        if (time_ >= 1140 * Time::MINUTE) return TimeOfDay::DUSK;
-        if (time_ >= 540 * Time::MINUTE) return TimeOfDay::DAY;
-        if (time_ >= 300 * Time::MINUTE) return TimeOfDay::DAWN;
-        return TimeOfDay::NIGHT;
+        case Season::WINTER: conditions |= TextTemplate::WINTER; break;
+        case Season::SPRING: conditions |= TextTemplate::SPRING; break;
+        case Season::SUMMER: conditions |= TextTemplate::SUMMER; break;
+        default: conditions |= TextTemplate::AUTUMN; break;
     }
+    if (!headless_) conditions |= (player().parent_room()->exposure().indoors ? TextTemplate::INSIDE : TextTemplate::OUTSIDE);
+    return conditions;
 }
 
+// Returns the current time of day (morning, day, dusk, night)
+TimeWeather::TimeOfDay TimeWeather::time_of_day(bool fine) { return calendar::time_of_day(calendar_time(), fine); }
+
 // Returns the exact time of day.
-int TimeWeather::time_of_day_exact() { return time_; }
+int TimeWeather::time_of_day_exact() { return calendar::time(calendar_time()); }
 
 // Returns the current time of day as a string.
 string TimeWeather::time_of_day_str(bool fine)
 {
-    if (fine)
-    {
-        if (time_ >= 1380 * Time::MINUTE) return "MIDNIGHT";
-        else if (time_ >= 1260 * Time::MINUTE) return "NIGHT";
-        else if (time_ >= 1140 * Time::MINUTE) return "DUSK";
-        else if (time_ >= 1020 * Time::MINUTE) return "SUNSET";
-        else if (time_ >= 660 * Time::MINUTE) return "NOON";
-        else if (time_ >= 540 * Time::MINUTE) return "MORNING";
-        else if (time_ >= 420 * Time::MINUTE) return "SUNRISE";
-        else if (time_ >= 300 * Time::MINUTE) return "DAWN";
-        return "NIGHT";
-    } else
-    {
-        if (time_ >= 1380 * Time::MINUTE) return "NIGHT";
-        if (time_ >= 1140 * Time::MINUTE) return "DUSK";
-        if (time_ >= 540 * Time::MINUTE) return "DAY";
-        if (time_ >= 300 * Time::MINUTE) return "DAWN";
-        return "NIGHT";
-    }
+    static const string tod_names[] = { "DAWN", "SUNRISE", "MORNING", "NOON", "SUNSET", "DUSK", "NIGHT", "MIDNIGHT", "DAY" };
+
+    // The small hours are MIDNIGHT as far as time_of_day() is concerned, but are still called NIGHT.
+    const TimeOfDay tod = time_of_day(fine);
+    if (tod == TimeOfDay::MIDNIGHT && time_of_day_exact() < 300 * Time::MINUTE) return "NIGHT";
+    return tod_names[static_cast<int>(tod)];
+}
+
+// Makes sure the current weather matches the Region the player is in.
+void TimeWeather::sync_region_weather()
+{
+    if (headless_) return;
+    const int region_id = player().region();
+    if (region_id == weather_region_) return;
+
+    // If the Region has no weather of its own yet, it takes on whatever the player has been seeing so far.
+    Region* region = world().load_region(region_id);
+    if (region->has_weather()) weather_ = region->weather();
+    else region->set_weather(weather_);
+    weather_region_ = region_id;
 }
 
 // Advances time by the smallest possible gradient; useful for loops waiting for something to happen.
@@ -422,25 +652,21 @@ unsigned long long TimeWeather::time_passed() { return time_passed_; }
 
 void TimeWeather::trigger_event(string *message_to_append, bool silent)
 {
-    const string weather_map = weather_change_map_.at(static_cast<int>(weather_));
-    switch (weather_map[rnd::get<int>(0, weather_map.size() - 1)])
-    {
-        case 'c': weather_ = Weather::CLEAR; break;
-        case 'f': weather_ = Weather::FAIR; break;
-        case 'r': weather_ = Weather::RAIN; break;
-        case 'F': weather_ = Weather::FOG; break;
-        case 'S': weather_ = Weather::STORMY; break;
-        case 'o': weather_ = Weather::OVERCAST; break;
-        case 'b': weather_ = Weather::BLIZZARD; break;
-        case 'l': weather_ = Weather::LIGHTSNOW; break;
-        case 'L': weather_ = Weather::SLEET; break;
-    }
+    step_region_weather();
     if (silent) return;
 
     // Display an appropriate message for the changing time/weather.
-    string time_message = string_map(time_of_day_str(true) + "_" + weather_str(fix_weather(weather_, current_season())));
-    if (message_to_append) *message_to_append += " " + time_message;
-    else print("{y}" + time_message);
+    // time_of_day_str() calls the small hours NIGHT rather than MIDNIGHT, so the message keys do the same.
+    const TimeOfDay tod = (time_of_day_exact() < 300 * Time::MINUTE ? TimeOfDay::NIGHT : time_of_day(true));
+    const Weather weather = fix_weather(weather_, current_season());
+    const short index = event_messages_[static_cast<int>(tod)][static_cast<int>(weather)];
+    string time_message = render_message(index, index < 0 ? time_of_day_str(true) + "_" + weather_str(weather) : "");
+    if (message_to_append)
+    {
+        *message_to_append += ' ';
+        *message_to_append += time_message;
+    }
+    else print(Format{"{y}%s", time_message});
 }
 
 // Gets the current weather, runs fix_weather() internally.
@@ -455,16 +681,29 @@ string TimeWeather::weather_desc()
 string TimeWeather::weather_desc(TimeWeather::Season season, bool trees)
 {
     const Weather weather = fix_weather(weather_, season);
-    string desc = string_map(season_str(season) + "_" + time_of_day_str(false) + "_" + weather_str(weather));
+    const TimeOfDay tod = time_of_day(false);
+    const auto &messages = desc_messages_[static_cast<int>(season) - 1];
+    short index = messages[static_cast<int>(tod)][static_cast<int>(weather)][0];
+    string desc = render_message(index, index < 0 ? season_str(season) + "_" + time_of_day_str(false) + "_" + weather_str(weather) : "");
     if (trees)
     {
-        string tree_time = "DAY";
-        if (time_of_day(false) == TimeOfDay::DUSK || time_of_day(false) == TimeOfDay::NIGHT) tree_time = "NIGHT";
-        desc += " " + string_map(season_str(season) + "_" + tree_time + "_" + weather_str(weather) + "_TREES");
+        const TimeOfDay tree_time = ((tod == TimeOfDay::DUSK || tod == TimeOfDay::NIGHT) ? TimeOfDay::NIGHT : TimeOfDay::DAY);
+        index = messages[static_cast<int>(tree_time)][static_cast<int>(weather)][1];
+        desc += " " + render_message(index, index < 0 ? season_str(season) + "_" + (tree_time == TimeOfDay::NIGHT ? "NIGHT_" : "DAY_") + weather_str(weather) +
+            "_TREES" : "");
     }
     return desc;
 }
 
+// Returns a number which changes whenever weather_desc() would return something different.
+uint32_t TimeWeather::weather_desc_stamp()
+{
+    const Season season = current_season();
+    const Room::Exposure &exposure = player().parent_room()->exposure();
+    return static_cast<uint32_t>(fix_weather(weather_, season)) | (static_cast<uint32_t>(time_of_day(false)) << 4) | (static_cast<uint32_t>(season) << 8) |
+        (static_cast<uint32_t>(wind_direction_) << 12) | (exposure.trees ? 1 << 16 : 0) | (exposure.city ? 1 << 17 : 0);
+}
+
 // Converts a weather integer to a string.
 string TimeWeather::weather_str(TimeWeather::Weather weather)
 {
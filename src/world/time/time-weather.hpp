@@ -22,9 +22,13 @@
 #pragma once
 #include "core/pch.hpp"
 
+#include <array>
 #include <cstdint>
 #include <map>
 
+#include "util/random.hpp"
+#include "world/time/scheduler.hpp"
+
 namespace westgate {
 
 enum class Direction : unsigned char;   // defined in world/area/link.hpp
@@ -42,20 +46,30 @@ public:
     enum class TimeOfDay : unsigned char { DAWN, SUNRISE, MORNING, NOON, SUNSET, DUSK, NIGHT, MIDNIGHT, DAY };
     enum class Weather : unsigned char { BLIZZARD, STORMY, RAIN, CLEAR, FAIR, OVERCAST, FOG, LIGHTSNOW, SLEET };
 
-                TimeWeather();              // Sets up the time and weather system with default values, and loads its strings into memory.
+                // Sets up the time and weather system with default values. A headless system has no Player or World to look at, and never prints anything.
+    explicit    TimeWeather(bool headless = false);
+                TimeWeather(const TimeWeather&) = delete;   // No copying; the scheduler's event handlers point back to this object.
+    TimeWeather&    operator=(const TimeWeather&) = delete;
+    uint8_t     climate_id(const std::string &name) const;  // Looks up a climate by name, or the default climate if the name is blank.
     Season      current_season();           // Gets the current season.
     std::string day_name();                 // Returns the name of the current day of the week.
     int         day_of_month();             // Returns the current day of the month.
     std::string day_of_month_string();      // Returns the day of the month in the form of a string like "1st" or "19th".
+    void        interrupt();                // Stops any interruptible passing of time, such as a long action, when something happens that needs a reaction.
     LightDark   light_dark();               // Checks whether it's light or dark right now.
     void        load_data(FileReader* file);    // Loads the time/weather data from the specified save file.
+    void        load_strings();             // Loads the time and weather strings into memory. Safe to call from a worker thread.
     std::string month_name();               // Returns the name of the current month.
     LunarPhase  moon_phase();               // Gets the current lunar phase.
     bool        pass_time(float seconds, bool allow_interrupt = false); // Causes time to pass.
+    void        reset(uint64_t world_seed); // Picks new starting conditions for a new game, with the random number streams seeded from the world seed.
     Season      room_season();              // Retrieves the season override (if any) for the current Room.
     void        save_data(FileWriter* file);    // Saves the time/weather data to the specified save file.
+    Scheduler&  scheduler();                // Returns a reference to the game-time event scheduler.
     std::string season_str(Season season);  // Converts a season integer to a string.
+    void        step_region_weather();      // Advances the weather in every resident Region at once.
     std::string string_map(const std::string_view key); // Retrieves a message directly from the string map, with tags processed.
+    uint16_t    text_conditions();          // Returns the TextTemplate conditions which are true right now, for the player's current surroundings.
     void        tick();                     // Advances time by the smallest possible gradient; useful for loops waiting for something to happen.
     TimeOfDay   time_of_day(bool fine);     // Returns the current time of day (morning, day, dusk, night)
     int         time_of_day_exact();        // Returns the exact time of day.
@@ -63,30 +77,67 @@ public:
     unsigned long long  time_passed();      // Returns the total amount of time passed in this game.
     Weather     weather();                  // Gets the current weather, runs fix_weather() internally.
     std::string weather_desc();             // Returns a weather description for the current time/weather, based on the current season.
+    uint32_t    weather_desc_stamp();       // Returns a number which changes whenever weather_desc() would return something different.
     std::string weather_str(Weather weather);   // Converts a weather integer to a string.
 
 private:
-    static constexpr int            LUNAR_CYCLE_DAYS =  29;     // How many days are in a lunar cycle?
     static constexpr float          TIME_GRANULARITY =  0.1f;   // The lower this number, the more fine-grained the accuracy of the passage of time becomes.
-    static constexpr unsigned int   TIME_WEATHER_SAVE_VERSION = 2;  // The version of the time/weather saved data in the saved game file.
+    static constexpr unsigned int   TIME_WEATHER_SAVE_VERSION = 6;  // The version of the time/weather saved data in the saved game file.
+    static constexpr int            WEATHER_TABLE_SIZE = 256;   // The maximum number of outcomes in each weather transition table.
+
+    // A piece of a time/weather message. Messages are split into these when they're loaded, so they don't need to be searched for tags each time they're shown.
+    struct MessageSegment {
+        enum class Type : unsigned char { TEXT, LOCALE_WORD, WIND_DIR };
+        Type            type;       // Whether this segment is plain text, or a word filled in when the message is shown.
+        uint16_t        conditions; // The TextTemplate conditions under which this segment is shown, such as only when the player is outside.
+        unsigned char   locale_word;    // For LOCALE_WORD segments, which entry in locale_words_ to use.
+        std::string     text;       // For TEXT segments, the text itself.
+    };
+    using Message = std::vector<MessageSegment>;
 
+    static const std::string    locale_words_[7][3];    // Tags which are replaced with different words in cities, in the form { tag, normal word, city word }.
+
+    static Message  compile_message(const std::string_view str);    // Splits a message from weather.yml into segments.
+    void            compile_message_tables();   // Builds the lookup tables used to find messages for each season, time of day and weather type.
+    unsigned long long  calendar_time() const;  // Returns the current time on the calendar.
+    void        change_time_of_day(const Scheduler::Event &event);  // Moves on to the next time of day, changing the weather, and schedules the next change.
+    void        change_wind(const Scheduler::Event &event);    // Changes the wind direction, and schedules the next change.
+                // Builds the weather transition tables for each climate from the weather maps in weather.yml.
+    void        compile_weather_tables(const std::map<std::string, std::array<std::string, 9>> &climate_maps);
     Weather     fix_weather(Weather weather, Season season);    // Fixes weather for a specified season.
+    std::string render_message(short index, const std::string_view key);    // Renders a compiled message for the player's current surroundings.
+                // Looks up the next weather for a batch of Regions, from their climates, current weather, and random rolls.
+    void        step_weather(const uint8_t* climates, uint8_t* weathers, const uint8_t* rolls, size_t count) const;
+    void        sync_region_weather();      // Makes sure the current weather matches the Region the player is in.
     void        trigger_event(std::string *message_to_append, bool silent); // Triggers a time-change event.
     bool        player_near_trees();                            // Is the player near trees right now?
+    unsigned long long  quiet_seconds(unsigned long long now);  // Returns how many seconds after the specified time will pass without anything happening.
     std::string weather_desc(Season season, bool trees);        // Returns a weather description for the current time/weather, based on the specified season.
 
-    int         day_;       // The current day of the year.
-    int         moon_;      // The current moon phase.
-    int         time_;      // The time of day.
+    unsigned long long  epoch_; // The calendar time when the game began. The date and time are worked out from this and time_passed_.
     unsigned long long  time_passed_;   // The total amount of time that has passed in this game.
     float       time_passed_subsecond_; // For counting time passed in amounts of time less than a second.
-    Weather     weather_;   // The current weather.
+    Weather     weather_;   // The current weather, in the Region the player is in.
+    int         weather_region_;    // The Region that weather_ currently belongs to, or -1 if it hasn't been checked yet.
     bool        wind_clockwise_;    // Is the wind direction changing in a clockwise direction?
     Direction   wind_direction_;    // The current direction the wind is blowing from.
     unsigned long long  wind_next_change_;  // The time when the wind is due to next change direction.
+    Scheduler::EventID  wind_event_;    // The scheduled event for the next wind change.
+    Scheduler::EventID  time_of_day_event_; // The scheduled event for the next time of day change.
+    bool        interrupted_;   // Has an interruption been requested?
+    bool        headless_;  // Is this running without a Player or World, such as in the weather simulation tool?
+    RandomStream    rng_weather_;   // Random numbers for the starting conditions, and the weather when running headless.
+    RandomStream    rng_wind_;      // Random numbers for the wind.
+
+    Scheduler   scheduler_; // Runs timed events as game time passes.
 
-    std::map<std::string, std::string>  tw_string_map_; // The time and weather transition strings.
-    std::vector<std::string>            weather_change_map_;    // Weather change maps, to determine odds of changing to different weather types.
+    short       desc_messages_[4][9][9][2]; // Indexes into messages_ for weather descriptions, by [season - 1][time of day][weather][trees], or -1 if missing.
+    short       event_messages_[9][9];  // Indexes into messages_ for time-of-day change messages, by [time of day][weather], or -1 if missing.
+    std::map<std::string, short>    message_keys_;  // Looks up the index in messages_ for each key in weather.yml.
+    std::vector<Message>            messages_;      // The time and weather messages, split into segments.
+    std::map<std::string, uint8_t>  climate_ids_;   // Looks up the ID of each climate by name. The default climate is blank, and always has ID 0.
+    std::vector<uint8_t>    weather_table_sizes_;   // The number of outcomes in each weather transition table, by [climate * 9 + weather].
+    std::vector<uint8_t>    weather_tables_;        // The weather transition tables, by [(climate * 9 + weather) * WEATHER_TABLE_SIZE + roll].
 };
 
 }   // namespace westgate
@@ -27,6 +27,7 @@ static constexpr int    MINUTE =    60;
 static constexpr int    HOUR =      60 * 60;
 static constexpr int    DAY =       60 * 60 * 24;
 
+static constexpr int    REAL_TIME_SCALE =   1;      // In real-time mode, how many seconds pass in the game world for each second of real time.
 static constexpr int    TIME_TO_MOVE =  30;         // The time it takes to move from one Room to another.
 static constexpr int    TIME_TO_WAIT =  5 * MINUTE; // The base time to wait if the "wait" command is used without specifying a time.
 
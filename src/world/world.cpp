@@ -17,15 +17,18 @@
  * GNU Affero General Public License for more details.
  */
 
+#include <algorithm>
 #include <filesystem>
 
 #include "core/core.hpp"
 #include "core/game.hpp"
 #include "core/terminal.hpp"
+#include "util/file-watcher.hpp"
 #include "util/filex.hpp"
+#include "util/format.hpp"
 #include "util/namegen.hpp"
 #include "util/strx.hpp"
-#include "util/timer.hpp"
+#include "util/task-graph.hpp"
 #include "world/area/automap.hpp"
 #include "world/area/region.hpp"
 #include "world/entity/player.hpp"
@@ -44,23 +47,30 @@ namespace fs = std::filesystem;
 
 namespace westgate {
 
-// Sets up the World object and loads static data into memory.
-World::World() : automap_ptr_(make_unique<Automap>()), namegen_ptr_(make_unique<ProcNameGen>()), time_weather_ptr_(make_unique<TimeWeather>())
+// Sets up the World object and starts loading static data into memory in the background.
+World::World() : automap_ptr_(make_unique<Automap>()), loading_tasks_(make_unique<TaskGraph>()), namegen_ptr_(make_unique<ProcNameGen>()), seed_(0),
+    time_weather_ptr_(make_unique<TimeWeather>()), watcher_ptr_(nullptr)
 {
-    Timer init_world;
     core().log("Loading static data into memory.");
-    namegen_ptr_->load_namelists();
-#ifdef WESTGATE_BUILD_DEBUG
-    core().log("Static data loaded in " + strx::ftos(init_world.elapsed() / 1000.0f, 3) + " seconds.");
-#endif
+    const size_t version_task = loading_tasks_->add("gamedata version check", [] { core().check_gamedata_version(); });
+    const size_t weather_task = loading_tasks_->add("time/weather strings", [this] { time_weather_ptr_->load_strings(); }, {version_task});
+    critical_tasks_ = {version_task, weather_task};
+
+    // The name lists aren't needed until the first NPC name is generated, so they're not critical. If they're needed before this finishes, the call to
+    // npc_name() will just wait for it.
+    loading_tasks_->add("name lists", [this] { namegen_ptr_->prefetch(); }, {version_task});
+    loading_timer_.reset();
+    loading_tasks_->start(core().thread_pool());
 }
 
 // Destructor, explicitly frees memory used.
 World::~World()
 {
+    loading_tasks_->wait_all(false);    // The loading tasks must not outlive the objects they're loading data into.
     automap_ptr_.reset(nullptr);
     namegen_ptr_.reset(nullptr);
     time_weather_ptr_.reset(nullptr);
+    watcher_ptr_.reset(nullptr);
 }
 
 // Updates the room_regions_ map to keep track of what Region each Room is in.
@@ -74,11 +84,23 @@ Automap& World::automap() const
     return *automap_ptr_;
 }
 
+// If watching the game data for changes, reloads any Regions whose files have been modified.
+void World::check_for_changes()
+{
+    if (!watcher_ptr_) return;
+    for (auto &filename : watcher_ptr_->changed_files())
+    {
+        if (fs::path(filename).extension() != ".yml") continue;
+        reload_regions(filename);
+    }
+}
+
 // Loads region data from YAML, and saves it as a new save file in the specified slot.
 void World::create_region_saves(int save_slot)
 {
     // This can be replaced with something better later.
     print("{c}Generating game world from static data...");
+    terminal::flush();
 
     // Create a game saves folder, if one doesn't already exist.
     const fs::path userdata_saves_path = filex::game_path("userdata/saves");
@@ -113,8 +135,31 @@ void World::debug_mark_room(const string_view room_name)
     if (room_name_hashes_used_.count(room_name_hash) > 0) throw runtime_error("Room name hash collision detected: " + string{room_name});
     room_name_hashes_used_.insert(room_name_hash);
 }
+
+// When in debug mode, forgets which Region a removed Room was in.
+void World::debug_remove_room_from_region(hash_wg room_id) { room_regions_.erase(room_id); }
 #endif
 
+// Waits for the critical static data to finish loading in the background. Must be called before starting a game.
+void World::finish_loading()
+{
+#ifdef WESTGATE_BUILD_DEBUG
+    Timer wait_timer;
+#endif
+    for (auto task : critical_tasks_)
+        loading_tasks_->wait(task);
+#ifdef WESTGATE_BUILD_DEBUG
+    for (size_t i = 0; i < loading_tasks_->size(); i++)
+    {
+        if (!loading_tasks_->done(i)) core().log("Loading task \"" + loading_tasks_->name(i) + "\" is still running in the background.");
+        else core().log("Loading task \"" + loading_tasks_->name(i) + "\" finished in " + strx::ftos(loading_tasks_->time_taken(i) / 1000.0f, 3) +
+            " seconds.");
+    }
+    core().log("Static data loaded in " + strx::ftos(loading_timer_.elapsed() / 1000.0f, 3) + " seconds (waited " +
+        strx::ftos(wait_timer.elapsed() / 1000.0f, 3) + " seconds).");
+#endif
+}
+
 // Attempts to find a room by its string ID.
 Room* World::find_room(const string_view id, int region_id)
 { return find_room(strx::murmur3(id), region_id); }
@@ -171,7 +216,7 @@ void World::open_close_lock_unlock_no_checks(Room* room, Direction dir, OpenClos
     if (!room->link_tag(dir, LinkTag::Openable)) throw runtime_error("Attempt to open/close/lock/unlock a non-Openable exit! [" + room->id_str() + "]");
     Room* dest_room = room->get_link(dir);
     const Direction reverse_dir = Room::reverse_direction(dir);
-    string action_str;
+    const char* action_str = "";    // The verb, as in "the door opens". Its plural form is the same without the last letter (the guards open the door).
     switch(type)
     {
         case OpenCloseLockUnlock::OPEN:
@@ -202,27 +247,19 @@ void World::open_close_lock_unlock_no_checks(Room* room, Direction dir, OpenClos
         !player_sees) return;
     const Direction player_sees_dir = (room == player_parent ? dir : reverse_dir);
     const string door_name = (room == player_parent ? room->door_name(dir) : dest_room->door_name(reverse_dir));
+    const char* where = (player_sees_dir == Direction::UP ? "above" : (player_sees_dir == Direction::DOWN ? "below" : "to the "));
+    const string_view where_dir = (player_sees_dir == Direction::UP || player_sees_dir == Direction::DOWN ? string_view{} :
+        string_view{Room::direction_name(player_sees_dir)});
 
     // If the Actor pointer exists (it can be nullptr to make a door open on its own) AND the Mobile is in the same room as the Player, we'll inform them that
     // the door has been opened by this Mobile.
-    string message;
     if (room == player_parent && actor && actor->parent_room() == player_parent)
     {
-        if (actor->tag(EntityTag::PluralName)) action_str.pop_back();
-        message = "{b}" + actor->name(NAME_FLAG_THE | NAME_FLAG_CAPITALIZE_FIRST) + " " + action_str + " the " + door_name;
-        if (player_sees_dir == Direction::UP) message += " above.";
-        else if (player_sees_dir == Direction::DOWN) message += " below.";
-        else message += " to the " + Room::direction_name(player_sees_dir) + ".";
+        string_view action = action_str;
+        if (actor->tag(EntityTag::PluralName)) action.remove_suffix(1);
+        print(Format{"{b}%s %s the %s %s%s.", actor->name(NAME_FLAG_THE | NAME_FLAG_CAPITALIZE_FIRST), action, door_name, where, where_dir});
     }
-    else
-    {
-        message = "{b}The " + door_name;
-        if (player_sees_dir == Direction::UP) message += " above ";
-        else if (player_sees_dir == Direction::DOWN) message += " below ";
-        else message += " to the " + Room::direction_name(player_sees_dir) + " ";
-        message += action_str + ".";
-    }
-    print(message);
+    else print(Format{"{b}The %s %s%s %s.", door_name, where, where_dir, action_str});
 }
 
 // Saves the game! Should only be called via Game::save().
@@ -232,6 +269,16 @@ void World::save(int save_slot)
         region.second->save_delta(save_slot);
 }
 
+// Returns the world seed, which every random number stream in the game world is derived from.
+uint64_t World::seed() const { return seed_; }
+
+// Sets the world seed, and reseeds the name generator from it.
+void World::set_seed(uint64_t seed)
+{
+    seed_ = seed;
+    namegen_ptr_->rng().seed_stream(seed, RandomStream::Stream::NAMEGEN);
+}
+
 // Returns a reference to the time/weather manager object.
 TimeWeather& World::time_weather() const
 {
@@ -239,6 +286,38 @@ TimeWeather& World::time_weather() const
     return *time_weather_ptr_;
 }
 
+// Reloads the game data for loaded Regions, or just the specified file.
+void World::reload_regions(const string_view filename)
+{
+    bool reloaded = false;
+    for (auto &region : regions_)
+    {
+        if (filename.size() && region.second->filename() != filename) continue;
+        try
+        {
+            region.second->reload_from_gamedata();
+            reloaded = true;
+        }
+        catch (std::exception &e)
+        {
+            // The builder has probably just made a typo, so there's no need to crash the game over it. The Region is left as it was.
+            core().nonfatal(e.what(), Core::CORE_ERROR);
+        }
+    }
+    if (reloaded) print("{c}Region data has been reloaded.");
+}
+
+// Returns all the Regions currently loaded into memory, in order of Region ID.
+vector<Region*> World::resident_regions() const
+{
+    vector<Region*> result;
+    result.reserve(regions_.size());
+    for (auto &region : regions_)
+        result.push_back(region.second.get());
+    std::sort(result.begin(), result.end(), [](const Region* a, const Region* b) { return a->id() < b->id(); });
+    return result;
+}
+
 // Removes a Region from memory, saving it first.
 void World::unload_region(int id)
 {
@@ -249,6 +328,13 @@ void World::unload_region(int id)
     regions_.erase(region);
 }
 
+// Starts watching the region game data files for changes.
+void World::watch_gamedata()
+{
+    watcher_ptr_ = make_unique<FileWatcher>(core().datafile("world/regions"));
+    if (!watcher_ptr_->active()) watcher_ptr_.reset(nullptr);
+}
+
 // Shortcut instead of using game()->world()
 World& world() { return game().world(); }
 
@@ -22,6 +22,8 @@
 
 #include <unordered_map>
 
+#include "util/timer.hpp"
+
 #ifdef WESTGATE_BUILD_DEBUG
 #include <set>
 #endif
@@ -29,10 +31,12 @@
 namespace westgate {
 
 class Automap;      // defined in world/area/automap.hpp
+class FileWatcher;  // defined in util/file-watcher.hpp
 class Mobile;       // defined in world/entity/mobile.hpp
 class ProcNameGen;  // defined in util/text/namegen.hpp
 class Region;       // defined in world/area/region.hpp
 class Room;         // defined in world/area/room.hpp
+class TaskGraph;    // defined in util/task-graph.hpp
 class TimeWeather;  // defined in world/time-weather.hpp
 enum class Direction : unsigned char;   // defined in world/area/area.hpp
 
@@ -40,33 +44,46 @@ class World {
 public:
     enum class OpenCloseLockUnlock : unsigned char { OPEN, CLOSE, LOCK, UNLOCK };
 
-                    World();    // Sets up the World object and loads static data into memory.
+                    World();    // Sets up the World object and starts loading static data into memory in the background.
                     ~World();   // Destructor, explicitly frees memory used.
     void            add_room_to_region(hash_wg room_id, int region_id); // Updates the room_regions_ map to keep track of what Region each Room is in.
     Automap&        automap() const;    // Returns a reference to the automap object.
+    void            check_for_changes();    // If watching the game data for changes, reloads any Regions whose files have been modified.
     void            create_region_saves(int save_slot); // Loads region data from YAML, and saves it as a new save file in the specified slot.
     Room*           find_room(const std::string_view id, int region_id);    // Attempts to find a room by its string ID.
     Room*           find_room(hash_wg id, int region_id);   // Attempts to find a room by its hashed ID.
     Room*           find_room(hash_wg id);  // As above, but doesn't specify Region ID. This is more computationally expensive.
     int             find_room_region(hash_wg id) const; // Attempts to find the Region that a specified Room belongs to.
+    void            finish_loading();       // Waits for the critical static data to finish loading in the background. Must be called before starting a game.
     Region*         load_region(int id);    // Specifies a Region to be loaded into memory.
     ProcNameGen&    namegen() const;        // Returns a reference to the procedural name generator object.
+    void            reload_regions(const std::string_view filename = "");  // Reloads the game data for loaded Regions, or just the specified file.
+    std::vector<Region*>    resident_regions() const;   // Returns all the Regions currently loaded into memory, in order of Region ID.
                     // Opens/closes/locks/unlocks a door, without checking for locks/etc. The checks should be done in player commands or Mobile AI.
     void            open_close_lock_unlock_no_checks(Room* room, Direction dir, OpenCloseLockUnlock type, Mobile* actor);
     void            save(int save_slot);    // Saves the game! Should only be called via Game::save().
+    uint64_t        seed() const;           // Returns the world seed, which every random number stream in the game world is derived from.
+    void            set_seed(uint64_t seed);    // Sets the world seed, and reseeds the name generator from it.
     TimeWeather&    time_weather() const;   // Returns a reference to the time/weather manager object.
     void            unload_region(int id);  // Removes a Region from memory, saving it first.
+    void            watch_gamedata();       // Starts watching the region game data files for changes.
 
 #ifdef WESTGATE_BUILD_DEBUG
     void            debug_mark_room(const std::string_view room_name);  // When in debug mode, mark name hashes as used, to track overlaps.
+    void            debug_remove_room_from_region(hash_wg room_id); // When in debug mode, forgets which Region a removed Room was in.
 #endif
 
 private:
     std::unique_ptr<Automap>        automap_ptr_;   // Pointer to the automapper object.
+    std::vector<size_t>             critical_tasks_;    // The loading tasks which must be finished before a game can start.
+    std::unique_ptr<TaskGraph>      loading_tasks_; // The static data loading tasks, which run in the background while the title screen is shown.
+    Timer                           loading_timer_; // Times the loading process as a whole.
     std::unique_ptr<ProcNameGen>    namegen_ptr_;   // Pointer to the procedural name-generator object.
     std::unordered_map<int, std::unique_ptr<Region>>    regions_;   // The Regions currently loaded into memory.
     std::unordered_map<hash_wg, int>    room_regions_;  // Lookup table to determine which Region each Room is located in.
+    uint64_t                        seed_;          // The world seed, which every random number stream in the game world is derived from.
     std::unique_ptr<TimeWeather>    time_weather_ptr_;  // Pointer to the time/weather manager object.
+    std::unique_ptr<FileWatcher>    watcher_ptr_;   // Watches the region game data files for changes, if requested.
 
 #ifdef WESTGATE_BUILD_DEBUG
     std::set<hash_wg>   room_name_hashes_used_; // When in debug mode, keeps track of which room names have been used; again, for overlap tracking.